@@ -0,0 +1,261 @@
+#ifndef RIDE_ANALYTICS_H
+#define RIDE_ANALYTICS_H
+
+#include "../rides/ride.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// Columnar slice of completed rides. Each field lives in its own contiguous
+// array so a report only touches the columns it actually reads.
+struct RideBatch {
+    static const size_t CAPACITY = 1 << 16;
+
+    vector<double> fare;
+    vector<double> distance;
+    vector<double> surgeMultiplier;
+    vector<uint8_t> vehicleType;
+    vector<int64_t> requestTimeMs;
+    vector<int64_t> startTimeMs;
+    vector<int64_t> endTimeMs;
+    vector<uint32_t> driverIndex;   // into RideColumnStore::getDriverId
+    vector<uint32_t> riderIndex;    // into RideColumnStore::getRiderId
+
+    RideBatch() {
+        fare.reserve(CAPACITY);
+        distance.reserve(CAPACITY);
+        surgeMultiplier.reserve(CAPACITY);
+        vehicleType.reserve(CAPACITY);
+        requestTimeMs.reserve(CAPACITY);
+        startTimeMs.reserve(CAPACITY);
+        endTimeMs.reserve(CAPACITY);
+        driverIndex.reserve(CAPACITY);
+        riderIndex.reserve(CAPACITY);
+    }
+
+    size_t size() const { return fare.size(); }
+    bool isFull() const { return fare.size() >= CAPACITY; }
+};
+
+class RideColumnStore {
+private:
+    vector<RideBatch> batches;
+    vector<string> driverIds;
+    vector<string> riderIds;
+    unordered_map<string, uint32_t> driverLookup;
+    unordered_map<string, uint32_t> riderLookup;
+    size_t rowCount;
+
+    static uint32_t intern(const string& id, vector<string>& ids,
+                           unordered_map<string, uint32_t>& lookup) {
+        auto it = lookup.find(id);
+        if (it != lookup.end()) return it->second;
+
+        uint32_t index = static_cast<uint32_t>(ids.size());
+        ids.push_back(id);
+        lookup.emplace(id, index);
+        return index;
+    }
+
+    static int64_t toMillis(chrono::system_clock::time_point time) {
+        return chrono::duration_cast<chrono::milliseconds>(time.time_since_epoch()).count();
+    }
+
+public:
+    RideColumnStore() : rowCount(0) {}
+
+    void appendRow(double fare, double distance, double surgeMultiplier, VehicleType type,
+                   int64_t requestTimeMs, int64_t startTimeMs, int64_t endTimeMs,
+                   const string& driverId, const string& riderId) {
+        if (batches.empty() || batches.back().isFull()) {
+            batches.emplace_back();
+        }
+
+        RideBatch& batch = batches.back();
+        batch.fare.push_back(fare);
+        batch.distance.push_back(distance);
+        batch.surgeMultiplier.push_back(surgeMultiplier);
+        batch.vehicleType.push_back(static_cast<uint8_t>(type));
+        batch.requestTimeMs.push_back(requestTimeMs);
+        batch.startTimeMs.push_back(startTimeMs);
+        batch.endTimeMs.push_back(endTimeMs);
+        batch.driverIndex.push_back(intern(driverId, driverIds, driverLookup));
+        batch.riderIndex.push_back(intern(riderId, riderIds, riderLookup));
+        rowCount++;
+    }
+
+    // Only completed rides are exported; anything else is skipped
+    bool append(const Ride& ride) {
+        if (ride.getStatus() != RideStatus::COMPLETED || !ride.getDriver()) return false;
+
+        appendRow(ride.getFare(), ride.getDistance(), ride.getSurgeMultiplier(),
+                  ride.getRequestedVehicleType(),
+                  toMillis(ride.getRequestTime()), toMillis(ride.getStartTime()),
+                  toMillis(ride.getEndTime()),
+                  ride.getDriver()->getUserId(), ride.getRider()->getUserId());
+        return true;
+    }
+
+    size_t appendCompleted(const RideMap& rides) {
+        size_t exported = 0;
+        for (const auto& entry : rides) {
+            if (append(*entry.second)) exported++;
+        }
+        return exported;
+    }
+
+    const vector<RideBatch>& getBatches() const { return batches; }
+    size_t getRowCount() const { return rowCount; }
+
+    size_t getDriverCount() const { return driverIds.size(); }
+    size_t getRiderCount() const { return riderIds.size(); }
+    const string& getDriverId(uint32_t index) const { return driverIds[index]; }
+    const string& getRiderId(uint32_t index) const { return riderIds[index]; }
+};
+
+struct GroupAggregate {
+    double sum;
+    double minValue;
+    double maxValue;
+    uint64_t count;
+
+    GroupAggregate()
+        : sum(0.0), minValue(numeric_limits<double>::max()),
+          maxValue(numeric_limits<double>::lowest()), count(0) {}
+
+    void add(double value) {
+        sum += value;
+        minValue = min(minValue, value);
+        maxValue = max(maxValue, value);
+        count++;
+    }
+
+    void merge(const GroupAggregate& other) {
+        sum += other.sum;
+        minValue = min(minValue, other.minValue);
+        maxValue = max(maxValue, other.maxValue);
+        count += other.count;
+    }
+
+    double average() const { return count ? sum / count : 0.0; }
+};
+
+// Filtered group-by over a RideColumnStore. Groups are dense integer keys so
+// every worker aggregates into a flat array, and workers pull whole batches
+// from a shared counter so uneven batches still balance across cores.
+class RideAnalytics {
+private:
+    const RideColumnStore& store;
+    unsigned threadCount;
+
+public:
+    static const size_t HOURS_PER_DAY = 24;
+    static const size_t VEHICLE_TYPE_COUNT = ::VEHICLE_TYPE_COUNT;   // follows VehicleType
+
+    explicit RideAnalytics(const RideColumnStore& s, unsigned threads = 0)
+        : store(s), threadCount(threads) {
+        if (threadCount == 0) {
+            threadCount = max(1u, thread::hardware_concurrency());
+        }
+    }
+
+    // keyFn(batch, row) must return a key < keyCount; valueFn(batch, row) the
+    // value to aggregate; filterFn(batch, row) decides whether the row counts
+    template <typename KeyFn, typename ValueFn, typename FilterFn>
+    vector<GroupAggregate> groupBy(size_t keyCount, KeyFn keyFn, ValueFn valueFn,
+                                   FilterFn filterFn) const {
+        const vector<RideBatch>& batches = store.getBatches();
+        unsigned workers = static_cast<unsigned>(
+            min<size_t>(threadCount, max<size_t>(1, batches.size())));
+
+        vector<vector<GroupAggregate>> partials(workers, vector<GroupAggregate>(keyCount));
+        atomic<size_t> nextBatch(0);
+
+        auto work = [&](unsigned worker) {
+            vector<GroupAggregate>& local = partials[worker];
+            size_t b;
+            while ((b = nextBatch.fetch_add(1, memory_order_relaxed)) < batches.size()) {
+                const RideBatch& batch = batches[b];
+                size_t rows = batch.size();
+                for (size_t row = 0; row < rows; row++) {
+                    if (!filterFn(batch, row)) continue;
+                    local[keyFn(batch, row)].add(valueFn(batch, row));
+                }
+            }
+        };
+
+        vector<thread> pool;
+        for (unsigned w = 1; w < workers; w++) {
+            pool.emplace_back(work, w);
+        }
+        work(0);
+        for (auto& t : pool) {
+            t.join();
+        }
+
+        vector<GroupAggregate> result(keyCount);
+        for (const auto& partial : partials) {
+            for (size_t k = 0; k < keyCount; k++) {
+                result[k].merge(partial[k]);
+            }
+        }
+        return result;
+    }
+
+    template <typename KeyFn, typename ValueFn>
+    vector<GroupAggregate> groupBy(size_t keyCount, KeyFn keyFn, ValueFn valueFn) const {
+        return groupBy(keyCount, keyFn, valueFn,
+                       [](const RideBatch&, size_t) { return true; });
+    }
+
+    // Revenue per vehicle type per hour of day (UTC, by ride end time).
+    // Result index is vehicleType * HOURS_PER_DAY + hour.
+    vector<GroupAggregate> revenueByVehicleTypeAndHour() const {
+        return groupBy(VEHICLE_TYPE_COUNT * HOURS_PER_DAY,
+            [](const RideBatch& batch, size_t row) {
+                size_t hour = static_cast<size_t>((batch.endTimeMs[row] / 3600000) % 24);
+                return batch.vehicleType[row] * HOURS_PER_DAY + hour;
+            },
+            [](const RideBatch& batch, size_t row) { return batch.fare[row]; });
+    }
+
+    // Index 0 holds rides without surge, index 1 rides with surge applied
+    vector<GroupAggregate> fareBySurgeState() const {
+        return groupBy(2,
+            [](const RideBatch& batch, size_t row) {
+                return batch.surgeMultiplier[row] > 1.0 ? size_t(1) : size_t(0);
+            },
+            [](const RideBatch& batch, size_t row) { return batch.fare[row]; });
+    }
+
+    // Fraction of [windowStartMs, windowEndMs) each driver spent on trips,
+    // indexed by driver index in the store
+    vector<double> driverUtilization(int64_t windowStartMs, int64_t windowEndMs) const {
+        vector<double> utilization(store.getDriverCount(), 0.0);
+        if (windowEndMs <= windowStartMs) return utilization;
+
+        vector<GroupAggregate> busy = groupBy(store.getDriverCount(),
+            [](const RideBatch& batch, size_t row) { return batch.driverIndex[row]; },
+            [windowStartMs, windowEndMs](const RideBatch& batch, size_t row) {
+                int64_t start = max(batch.startTimeMs[row], windowStartMs);
+                int64_t end = min(batch.endTimeMs[row], windowEndMs);
+                return static_cast<double>(end - start);
+            },
+            [windowStartMs, windowEndMs](const RideBatch& batch, size_t row) {
+                return batch.endTimeMs[row] > windowStartMs &&
+                       batch.startTimeMs[row] < windowEndMs;
+            });
+
+        double window = static_cast<double>(windowEndMs - windowStartMs);
+        for (size_t d = 0; d < busy.size(); d++) {
+            utilization[d] = busy[d].sum / window;
+        }
+        return utilization;
+    }
+};
+
+#endif
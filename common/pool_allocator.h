@@ -0,0 +1,147 @@
+#ifndef POOL_ALLOCATOR_H
+#define POOL_ALLOCATOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <vector>
+
+using namespace std;
+
+// Fixed-size block pool: blocks are carved out of large chunks and recycled
+// through an intrusive free list, so steady-state allocate/deallocate never
+// reach the global heap. Every pool registers itself so reserveAll() can
+// pre-size pools whose element types are internal to the standard library
+// (shared_ptr control blocks, hash map nodes).
+class BlockPool {
+private:
+    struct FreeBlock {
+        FreeBlock* next;
+    };
+
+    size_t blockSize;
+    FreeBlock* freeList;
+    size_t freeCount;
+    vector<unique_ptr<char[]>> chunks;
+    mutex poolMutex;
+
+    static mutex& registryMutex() {
+        static mutex m;
+        return m;
+    }
+
+    static vector<BlockPool*>& registry() {
+        static vector<BlockPool*> pools;
+        return pools;
+    }
+
+    static size_t& reserveHint() {
+        static size_t hint = 64;
+        return hint;
+    }
+
+    // Caller holds poolMutex
+    void grow(size_t blocks) {
+        chunks.emplace_back(new char[blockSize * blocks]);
+        char* base = chunks.back().get();
+        for (size_t i = 0; i < blocks; i++) {
+            FreeBlock* block = reinterpret_cast<FreeBlock*>(base + i * blockSize);
+            block->next = freeList;
+            freeList = block;
+        }
+        freeCount += blocks;
+    }
+
+public:
+    BlockPool(size_t size, size_t alignment)
+        : blockSize(0), freeList(nullptr), freeCount(0) {
+        alignment = max(alignment, alignof(FreeBlock));
+        size = max(size, sizeof(FreeBlock));
+        blockSize = (size + alignment - 1) / alignment * alignment;
+
+        lock_guard<mutex> lock(registryMutex());
+        registry().push_back(this);
+        reserve(reserveHint());
+    }
+
+    BlockPool(const BlockPool&) = delete;
+    BlockPool& operator=(const BlockPool&) = delete;
+
+    void* allocate() {
+        lock_guard<mutex> lock(poolMutex);
+        if (freeList == nullptr) {
+            grow(max<size_t>(64, chunks.size() * 64));
+        }
+        FreeBlock* block = freeList;
+        freeList = block->next;
+        freeCount--;
+        return block;
+    }
+
+    void deallocate(void* p) {
+        lock_guard<mutex> lock(poolMutex);
+        FreeBlock* block = static_cast<FreeBlock*>(p);
+        block->next = freeList;
+        freeList = block;
+        freeCount++;
+    }
+
+    // Ensures at least 'blocks' blocks can be handed out without growing
+    void reserve(size_t blocks) {
+        lock_guard<mutex> lock(poolMutex);
+        if (freeCount < blocks) {
+            grow(blocks - freeCount);
+        }
+    }
+
+    // Tops up every existing pool, and sizes pools created later, to 'blocks'
+    static void reserveAll(size_t blocks) {
+        lock_guard<mutex> lock(registryMutex());
+        reserveHint() = max(reserveHint(), blocks);
+        for (BlockPool* pool : registry()) {
+            pool->reserve(blocks);
+        }
+    }
+};
+
+// STL allocator over one BlockPool per element type. Single-element requests
+// (nodes, control blocks) come from the pool; arrays such as hash bucket
+// tables fall back to the global heap.
+template <typename T>
+class PoolAllocator {
+public:
+    typedef T value_type;
+
+    PoolAllocator() noexcept {}
+
+    template <typename U>
+    PoolAllocator(const PoolAllocator<U>&) noexcept {}
+
+    static BlockPool& pool() {
+        static BlockPool instance(sizeof(T), alignof(T));
+        return instance;
+    }
+
+    T* allocate(size_t n) {
+        if (n == 1) return static_cast<T*>(pool().allocate());
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t n) noexcept {
+        if (n == 1) {
+            pool().deallocate(p);
+        } else {
+            ::operator delete(p);
+        }
+    }
+
+    template <typename U>
+    bool operator==(const PoolAllocator<U>&) const noexcept { return true; }
+
+    template <typename U>
+    bool operator!=(const PoolAllocator<U>&) const noexcept { return false; }
+};
+
+#endif
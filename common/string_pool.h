@@ -0,0 +1,121 @@
+#ifndef STRING_POOL_H
+#define STRING_POOL_H
+
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <unordered_map>
+#include <utility>
+
+using namespace std;
+
+// Immutable, reference-counted handle to a string stored once in a
+// process-wide table. Copies bump an atomic count and never allocate or lock,
+// so values such as addresses can be passed around the ride path without
+// duplicating heap buffers. Building a handle from text takes the table lock,
+// and an entry is erased when its last handle goes away, so the table only
+// holds strings that are still referenced somewhere.
+class InternedString {
+private:
+    typedef unordered_map<string, atomic<size_t>> Table;
+    typedef Table::value_type Entry;
+
+    Entry* entry;   // nullptr for the empty string
+
+    // Never destroyed, so handles in static objects can outlive other statics
+    static Table& table() {
+        static Table* entries = new Table();
+        return *entries;
+    }
+
+    static mutex& tableMutex() {
+        static mutex* lock = new mutex();
+        return *lock;
+    }
+
+    static Entry* acquire(const string& text) {
+        lock_guard<mutex> lock(tableMutex());
+        Entry& e = *table().emplace(piecewise_construct, forward_as_tuple(text),
+                                    forward_as_tuple(0)).first;
+        e.second.fetch_add(1, memory_order_relaxed);
+        return &e;
+    }
+
+    void retain() {
+        if (entry) entry->second.fetch_add(1, memory_order_relaxed);
+    }
+
+    // Drops one reference. Only the 1 -> 0 transition takes the lock; acquire()
+    // also runs under it, so an entry cannot be revived while it is erased.
+    void release() {
+        if (!entry) return;
+        size_t refs = entry->second.load(memory_order_relaxed);
+        while (refs > 1) {
+            if (entry->second.compare_exchange_weak(refs, refs - 1, memory_order_acq_rel)) {
+                entry = nullptr;
+                return;
+            }
+        }
+
+        lock_guard<mutex> lock(tableMutex());
+        if (entry->second.fetch_sub(1, memory_order_acq_rel) == 1) {
+            table().erase(entry->first);
+        }
+        entry = nullptr;
+    }
+
+    static const string& blank() {
+        static const string* emptyValue = new string();
+        return *emptyValue;
+    }
+
+public:
+    InternedString() : entry(nullptr) {}
+    InternedString(const string& text) : entry(text.empty() ? nullptr : acquire(text)) {}
+    InternedString(const char* text) : InternedString(string(text)) {}
+
+    InternedString(const InternedString& other) : entry(other.entry) { retain(); }
+    InternedString(InternedString&& other) noexcept : entry(other.entry) { other.entry = nullptr; }
+
+    InternedString& operator=(const InternedString& other) {
+        if (entry != other.entry) {
+            release();
+            entry = other.entry;
+            retain();
+        }
+        return *this;
+    }
+
+    InternedString& operator=(InternedString&& other) noexcept {
+        if (this != &other) {
+            release();
+            entry = other.entry;
+            other.entry = nullptr;
+        }
+        return *this;
+    }
+
+    ~InternedString() { release(); }
+
+    const string& str() const { return entry ? entry->first : blank(); }
+    operator const string&() const { return str(); }
+    bool empty() const { return entry == nullptr; }
+
+    // Live interned values are unique, so identity implies equality
+    bool operator==(const InternedString& other) const { return entry == other.entry; }
+    bool operator!=(const InternedString& other) const { return entry != other.entry; }
+
+    // Distinct strings currently referenced by at least one handle
+    static size_t getPoolSize() {
+        lock_guard<mutex> lock(tableMutex());
+        return table().size();
+    }
+};
+
+inline ostream& operator<<(ostream& out, const InternedString& text) {
+    return out << text.str();
+}
+
+#endif
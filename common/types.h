@@ -5,6 +5,7 @@
 #include <memory>
 #include <cmath>
 #include <iostream>
+#include "string_pool.h"
 
 using namespace std;
 
@@ -20,14 +21,28 @@ enum class RideStatus {
 enum class DriverStatus {
     AVAILABLE,
     ON_TRIP,
-    OFFLINE
+    OFFLINE,
+    OFFERED     // holding a ride offer; not matched to other rides until it is answered
 };
 
 enum class VehicleType {
     BIKE,
     SEDAN,
     SUV,
-    AUTO_RICKSHAW
+    AUTO_RICKSHAW,
+    COUNT           // number of vehicle types; keep last, arrays are sized by it
+};
+
+const size_t VEHICLE_TYPE_COUNT = static_cast<size_t>(VehicleType::COUNT);
+
+enum class CancellationReason {
+    NONE,
+    RIDER_CANCELLED,
+    DRIVER_CANCELLED,
+    ASSIGNMENT_TIMEOUT,
+    PICKUP_TIMEOUT,
+    RIDER_NO_SHOW,
+    NO_DRIVER_ACCEPTED
 };
 
 enum class RideType {
@@ -38,11 +53,18 @@ enum class RideType {
 struct Location {
     double latitude;
     double longitude;
-    string address;
+    InternedString address;    // interned so copying a Location never allocates
     
     Location(double lat = 0.0, double lng = 0.0, const string& addr = "")
         : latitude(lat), longitude(lng), address(addr) {}
     
+    // Finite and within [-90, 90] x [-180, 180]; anything else is rejected
+    // before it reaches the trace encoder, the heatmap or the geofence
+    bool hasValidCoordinates() const {
+        return std::isfinite(latitude) && std::isfinite(longitude) &&
+               fabs(latitude) <= 90.0 && fabs(longitude) <= 180.0;
+    }
+    
     double distanceTo(const Location& other) const {
         // Simplified distance calculation (Euclidean distance)
         double dx = latitude - other.latitude;
@@ -0,0 +1,196 @@
+#ifndef RCU_CELL_H
+#define RCU_CELL_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+// Epoch-based read-copy-update. Readers announce the global epoch they
+// started in through a per-thread slot (one store, no locks, no shared
+// counters); writers publish a new version, bump the epoch, and free an old
+// version once no reader that could still see it remains active.
+class EpochDomain {
+private:
+    struct ReaderSlot {
+        atomic<uint64_t> epoch;     // 0 while the thread is outside any read section
+        atomic<bool> inUse;
+        ReaderSlot* next;
+        unsigned depth;             // nesting, touched only by the owning thread
+        char padding[64];           // keep neighbouring slots off the same cache line
+
+        ReaderSlot() : epoch(0), inUse(true), next(nullptr), depth(0) {}
+    };
+
+    struct SlotHolder {
+        ReaderSlot* slot;
+        SlotHolder() : slot(nullptr) {}
+        ~SlotHolder() {
+            if (slot) slot->inUse.store(false, memory_order_release);
+        }
+    };
+
+    atomic<ReaderSlot*> slots;
+    atomic<uint64_t> globalEpoch;
+
+    EpochDomain() : slots(nullptr), globalEpoch(1) {}
+
+    // Slots are never freed; a slot released by an exited thread is reused
+    ReaderSlot* acquireSlot() {
+        for (ReaderSlot* s = slots.load(memory_order_acquire); s; s = s->next) {
+            bool expected = false;
+            if (!s->inUse.load(memory_order_relaxed) &&
+                s->inUse.compare_exchange_strong(expected, true)) {
+                return s;
+            }
+        }
+
+        ReaderSlot* s = new ReaderSlot();
+        ReaderSlot* head = slots.load(memory_order_relaxed);
+        do {
+            s->next = head;
+        } while (!slots.compare_exchange_weak(head, s, memory_order_release,
+                                              memory_order_relaxed));
+        return s;
+    }
+
+    ReaderSlot& localSlot() {
+        thread_local SlotHolder holder;
+        if (holder.slot == nullptr) holder.slot = acquireSlot();
+        return *holder.slot;
+    }
+
+public:
+    // Function-local static so concurrent first use from several threads is safe
+    static EpochDomain& getInstance() {
+        static EpochDomain instance;
+        return instance;
+    }
+
+    void enterRead() {
+        ReaderSlot& slot = localSlot();
+        if (slot.depth++ == 0) {
+            slot.epoch.store(globalEpoch.load(memory_order_seq_cst), memory_order_seq_cst);
+        }
+    }
+
+    void exitRead() {
+        ReaderSlot& slot = localSlot();
+        if (--slot.depth == 0) {
+            slot.epoch.store(0, memory_order_release);
+        }
+    }
+
+    // Called by a writer after unpublishing a version; readers announcing an
+    // epoch up to the returned value may still hold that version
+    uint64_t retireEpoch() {
+        return globalEpoch.fetch_add(1, memory_order_seq_cst);
+    }
+
+    uint64_t oldestActiveEpoch() const {
+        uint64_t oldest = numeric_limits<uint64_t>::max();
+        for (ReaderSlot* s = slots.load(memory_order_acquire); s; s = s->next) {
+            uint64_t e = s->epoch.load(memory_order_seq_cst);
+            if (e != 0 && e < oldest) oldest = e;
+        }
+        return oldest;
+    }
+};
+
+// Holds one immutable version of T. read() never blocks and never allocates
+// after the thread's first read; publish() swaps in a new version while
+// in-flight readers keep using the one they started with.
+template <typename T>
+class RcuCell {
+private:
+    atomic<T*> current;
+    atomic<uint64_t> version;
+    mutex writerMutex;
+    vector<pair<uint64_t, unique_ptr<T>>> retired;  // guarded by writerMutex
+
+    // Caller holds writerMutex
+    size_t reclaimLocked() {
+        if (retired.empty()) return 0;
+        uint64_t oldest = EpochDomain::getInstance().oldestActiveEpoch();
+        size_t before = retired.size();
+        retired.erase(remove_if(retired.begin(), retired.end(),
+            [oldest](const pair<uint64_t, unique_ptr<T>>& entry) {
+                return entry.first < oldest;
+            }), retired.end());
+        return before - retired.size();
+    }
+
+public:
+    class ReadGuard {
+    private:
+        const T* value;
+        bool active;
+
+    public:
+        explicit ReadGuard(const T* v) : value(v), active(true) {}
+        ReadGuard(ReadGuard&& other) : value(other.value), active(other.active) {
+            other.active = false;
+        }
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+
+        ~ReadGuard() {
+            if (active) EpochDomain::getInstance().exitRead();
+        }
+
+        const T* get() const { return value; }
+        const T* operator->() const { return value; }
+        const T& operator*() const { return *value; }
+    };
+
+    explicit RcuCell(unique_ptr<T> initial) : current(initial.release()), version(1) {}
+
+    // Assumes no readers remain when the cell itself is destroyed
+    ~RcuCell() {
+        delete current.load();
+    }
+
+    RcuCell(const RcuCell&) = delete;
+    RcuCell& operator=(const RcuCell&) = delete;
+
+    ReadGuard read() const {
+        EpochDomain::getInstance().enterRead();
+        return ReadGuard(current.load(memory_order_seq_cst));
+    }
+
+    // Returns the new version number; the replaced version is freed by the
+    // first publish() or reclaim() after the readers that could still see it
+    // have finished
+    uint64_t publish(unique_ptr<T> next) {
+        lock_guard<mutex> lock(writerMutex);
+        T* old = current.exchange(next.release(), memory_order_seq_cst);
+        uint64_t newVersion = version.fetch_add(1, memory_order_acq_rel) + 1;
+        retired.emplace_back(EpochDomain::getInstance().retireEpoch(), unique_ptr<T>(old));
+        reclaimLocked();
+        return newVersion;
+    }
+
+    // Frees retired versions no reader can still reach; returns how many.
+    // publish() only reclaims what is already safe at that moment, so a
+    // version a reader still held then stays retired until this is called
+    // (cheap when nothing is retired; meant for a periodic housekeeping tick).
+    size_t reclaim() {
+        lock_guard<mutex> lock(writerMutex);
+        return reclaimLocked();
+    }
+
+    size_t getPendingReclaimCount() {
+        lock_guard<mutex> lock(writerMutex);
+        return retired.size();
+    }
+
+    uint64_t getVersion() const { return version.load(memory_order_acquire); }
+};
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef DISPATCH_CONFIG_H
+#define DISPATCH_CONFIG_H
+
+#include "../strategies/matching_strategy.h"
+#include "../pricing/fare_calculator.h"
+#include <cstdint>
+
+// Immutable snapshot of the pluggable dispatch policy. RideManager publishes a
+// new snapshot on every change instead of mutating the live one, so requests
+// already running keep the strategy and pricing chain they started with.
+// Components that did not change are shared between consecutive snapshots.
+// The RcuCell holding the current snapshot is the only part of RideManager
+// that is safe to use from several threads; tools/rcu_stress.cpp checks it
+// under ThreadSanitizer.
+struct DispatchConfig {
+    shared_ptr<MatchingStrategy> matchingStrategy;
+    shared_ptr<FareCalculator> fareCalculator;
+    uint64_t version;
+
+    DispatchConfig(shared_ptr<MatchingStrategy> strategy,
+                   shared_ptr<FareCalculator> calculator, uint64_t ver)
+        : matchingStrategy(strategy), fareCalculator(calculator), version(ver) {}
+};
+
+#endif
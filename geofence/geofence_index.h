@@ -0,0 +1,504 @@
+#ifndef GEOFENCE_INDEX_H
+#define GEOFENCE_INDEX_H
+
+#include "../common/types.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <sstream>
+#include <vector>
+
+enum class ZoneType : uint8_t {
+    SERVICE_AREA,   // once any exist, pickups and dropoffs must fall inside one
+    NO_SERVICE,     // pickups and dropoffs inside are rejected
+    SPECIAL_FARE    // airports, stations: pickup surcharge and vehicle restrictions
+};
+
+// Bit per VehicleType, indexed by the enum value
+static_assert(VEHICLE_TYPE_COUNT <= 8, "vehicle type masks are 8 bits wide");
+const uint8_t ALL_VEHICLE_TYPES = static_cast<uint8_t>((1u << VEHICLE_TYPE_COUNT) - 1);
+
+inline uint8_t vehicleTypeBit(VehicleType type) {
+    return static_cast<uint8_t>(1u << static_cast<unsigned>(type));
+}
+
+struct GeoBox {
+    double minLat;
+    double minLng;
+    double maxLat;
+    double maxLng;
+
+    GeoBox()
+        : minLat(numeric_limits<double>::max()), minLng(numeric_limits<double>::max()),
+          maxLat(numeric_limits<double>::lowest()), maxLng(numeric_limits<double>::lowest()) {}
+
+    void expand(double lat, double lng) {
+        minLat = min(minLat, lat);
+        minLng = min(minLng, lng);
+        maxLat = max(maxLat, lat);
+        maxLng = max(maxLng, lng);
+    }
+
+    void expand(const GeoBox& other) {
+        minLat = min(minLat, other.minLat);
+        minLng = min(minLng, other.minLng);
+        maxLat = max(maxLat, other.maxLat);
+        maxLng = max(maxLng, other.maxLng);
+    }
+
+    bool contains(double lat, double lng) const {
+        return lat >= minLat && lat <= maxLat && lng >= minLng && lng <= maxLng;
+    }
+};
+
+// Simple polygon in lat/lng treated as planar, which is accurate enough at
+// city scale. Edges are bucketed into horizontal latitude bands, each band
+// holding its own contiguous copy of the edges crossing it, so a containment
+// test only ray-casts against a handful of edges in one run of memory.
+class GeoPolygon {
+private:
+    struct Edge {
+        double lat0;
+        double lng0;
+        double lat1;
+        double lng1;
+    };
+
+    GeoBox box;
+    size_t vertexCount;
+    size_t bandCount;
+    double bandHeight;
+    vector<uint32_t> bandStart;     // edges of band b are bandEdges[bandStart[b], bandStart[b+1])
+    vector<Edge> bandEdges;
+
+    size_t bandFor(double lat) const {
+        if (bandHeight <= 0.0 || lat <= box.minLat) return 0;
+        size_t band = static_cast<size_t>((lat - box.minLat) / bandHeight);
+        return min(band, bandCount - 1);
+    }
+
+    void buildBands(const vector<Location>& vertices) {
+        size_t edges = vertices.size();
+        bandCount = max<size_t>(1, min<size_t>(edges / 4, 256));
+        bandHeight = (box.maxLat - box.minLat) / bandCount;
+
+        // Counting sort of edges into every band their latitude span touches
+        vector<uint32_t> counts(bandCount + 1, 0);
+        bandStart.assign(bandCount + 1, 0);
+        for (int pass = 0; pass < 2; pass++) {
+            for (size_t i = 0; i < edges; i++) {
+                const Location& a = vertices[i];
+                const Location& b = vertices[(i + 1) % edges];
+                size_t first = bandFor(min(a.latitude, b.latitude));
+                size_t last = bandFor(max(a.latitude, b.latitude));
+                for (size_t band = first; band <= last; band++) {
+                    if (pass == 0) {
+                        counts[band + 1]++;
+                    } else {
+                        Edge& edge = bandEdges[bandStart[band] + counts[band]++];
+                        edge.lat0 = a.latitude;
+                        edge.lng0 = a.longitude;
+                        edge.lat1 = b.latitude;
+                        edge.lng1 = b.longitude;
+                    }
+                }
+            }
+            if (pass == 0) {
+                for (size_t band = 0; band < bandCount; band++) {
+                    bandStart[band + 1] = bandStart[band] + counts[band + 1];
+                }
+                bandEdges.resize(bandStart[bandCount]);
+                fill(counts.begin(), counts.end(), 0);
+            }
+        }
+    }
+
+public:
+    GeoPolygon() : vertexCount(0), bandCount(1), bandHeight(0.0), bandStart(2, 0) {}
+
+    // Vertices in order, without repeating the first one at the end
+    explicit GeoPolygon(const vector<Location>& vertices)
+        : vertexCount(vertices.size()), bandCount(1), bandHeight(0.0) {
+        for (const auto& v : vertices) {
+            box.expand(v.latitude, v.longitude);
+        }
+        buildBands(vertices);
+    }
+
+    const GeoBox& getBounds() const { return box; }
+    size_t getVertexCount() const { return vertexCount; }
+
+    // Even-odd ray cast towards increasing longitude
+    bool contains(double lat, double lng) const {
+        if (vertexCount < 3 || !box.contains(lat, lng)) return false;
+
+        size_t band = bandFor(lat);
+        bool inside = false;
+        for (uint32_t k = bandStart[band]; k < bandStart[band + 1]; k++) {
+            const Edge& e = bandEdges[k];
+            if ((e.lat0 > lat) != (e.lat1 > lat)) {
+                double crossLng = e.lng0 + (lat - e.lat0) * (e.lng1 - e.lng0) / (e.lat1 - e.lat0);
+                if (lng < crossLng) inside = !inside;
+            }
+        }
+        return inside;
+    }
+};
+
+struct GeoZone {
+    InternedString zoneId;      // interned so checks can hand it out without a pointer into the index
+    string name;
+    ZoneType type;
+    double pickupSurcharge;     // flat amount added to fares picked up inside
+    uint8_t allowedVehicles;    // vehicleTypeBit mask of types allowed to pick up inside
+    GeoPolygon polygon;
+
+    bool allows(VehicleType vehicle) const { return (allowedVehicles & vehicleTypeBit(vehicle)) != 0; }
+};
+
+enum class ServiceDecision {
+    ALLOWED,
+    OUTSIDE_SERVICE_AREA,
+    NO_SERVICE_ZONE,
+    VEHICLE_RESTRICTED
+};
+
+struct ServiceCheck {
+    ServiceDecision decision;
+    InternedString zoneId;  // zone responsible for a rejection, if any; owns its
+                            // text, so it outlives a rebuilt or replaced index
+
+    ServiceCheck(ServiceDecision d = ServiceDecision::ALLOWED,
+                 const InternedString& zone = InternedString())
+        : decision(d), zoneId(zone) {}
+
+    bool isAllowed() const { return decision == ServiceDecision::ALLOWED; }
+
+    const char* getDecisionString() const {
+        switch (decision) {
+            case ServiceDecision::ALLOWED: return "Allowed";
+            case ServiceDecision::OUTSIDE_SERVICE_AREA: return "Outside service area";
+            case ServiceDecision::NO_SERVICE_ZONE: return "No-service zone";
+            case ServiceDecision::VEHICLE_RESTRICTED: return "Vehicle type not allowed in zone";
+            default: return "Unknown";
+        }
+    }
+};
+
+// Zone polygons indexed by a packed R-tree over their bounding boxes. The
+// tree is bulk-loaded with Sort-Tile-Recursive packing, so nodes are full and
+// stored contiguously; a point query descends only into nodes whose boxes
+// contain the point and then runs the banded polygon test on the few zones
+// left. Queries are const, allocation-free and safe from several threads;
+// adding zones is not, and takes effect at the next build().
+class GeofenceIndex {
+private:
+    static const size_t NODE_CAPACITY = 16;
+    static const size_t MAX_QUERY_STACK = 256;
+
+    // Child boxes are stored column-wise and unused slots hold an empty box,
+    // so a node is tested against a point in one branch-free pass
+    struct Node {
+        double minLat[NODE_CAPACITY];
+        double minLng[NODE_CAPACITY];
+        double maxLat[NODE_CAPACITY];
+        double maxLng[NODE_CAPACITY];
+        uint32_t children[NODE_CAPACITY];   // zone indices in leaves, node indices otherwise
+        uint32_t count;
+        bool leaf;
+
+        void setBox(size_t k, const GeoBox& box) {
+            minLat[k] = box.minLat;
+            minLng[k] = box.minLng;
+            maxLat[k] = box.maxLat;
+            maxLng[k] = box.maxLng;
+        }
+
+        // Bit k is set when child k's box contains the point
+        uint32_t match(double lat, double lng) const {
+            uint32_t mask = 0;
+            for (size_t k = 0; k < NODE_CAPACITY; k++) {
+                uint32_t hit = (lat >= minLat[k]) & (lat <= maxLat[k]) &
+                               (lng >= minLng[k]) & (lng <= maxLng[k]);
+                mask |= hit << k;
+            }
+            return mask;
+        }
+    };
+
+    static uint32_t lowestBit(uint32_t mask) {
+#if defined(__GNUC__)
+        return static_cast<uint32_t>(__builtin_ctz(mask));
+#else
+        uint32_t bit = 0;
+        while (!(mask & 1)) {
+            mask >>= 1;
+            bit++;
+        }
+        return bit;
+#endif
+    }
+
+    vector<GeoZone> zones;
+    vector<Node> nodes;
+    uint32_t root;
+    size_t height;
+    bool hasServiceAreas;
+
+    struct Entry {
+        GeoBox box;
+        uint32_t id;
+    };
+
+    static double centerLat(const Entry& e) { return (e.box.minLat + e.box.maxLat) * 0.5; }
+    static double centerLng(const Entry& e) { return (e.box.minLng + e.box.maxLng) * 0.5; }
+
+    // Packs one level of entries into nodes; returns the entries for the level above
+    vector<Entry> packLevel(vector<Entry>& entries, bool leaf) {
+        size_t nodeCount = (entries.size() + NODE_CAPACITY - 1) / NODE_CAPACITY;
+        size_t slices = static_cast<size_t>(ceil(sqrt(static_cast<double>(nodeCount))));
+        size_t sliceSize = slices * NODE_CAPACITY;
+
+        sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+            return centerLat(a) < centerLat(b);
+        });
+        for (size_t start = 0; start < entries.size(); start += sliceSize) {
+            auto end = entries.begin() + min(entries.size(), start + sliceSize);
+            sort(entries.begin() + start, end, [](const Entry& a, const Entry& b) {
+                return centerLng(a) < centerLng(b);
+            });
+        }
+
+        vector<Entry> parents;
+        parents.reserve(nodeCount);
+        for (size_t start = 0; start < entries.size(); start += NODE_CAPACITY) {
+            Node node;
+            for (size_t k = 0; k < NODE_CAPACITY; k++) node.setBox(k, GeoBox());
+            node.leaf = leaf;
+            size_t remaining = entries.size() - start;
+            node.count = static_cast<uint32_t>(remaining < NODE_CAPACITY ? remaining : NODE_CAPACITY);
+
+            Entry parent;
+            parent.id = static_cast<uint32_t>(nodes.size());
+            for (uint32_t k = 0; k < node.count; k++) {
+                node.setBox(k, entries[start + k].box);
+                node.children[k] = entries[start + k].id;
+                parent.box.expand(entries[start + k].box);
+            }
+            nodes.push_back(node);
+            parents.push_back(parent);
+        }
+        return parents;
+    }
+
+    static bool parseZoneType(const string& text, ZoneType& type) {
+        if (text == "service_area") type = ZoneType::SERVICE_AREA;
+        else if (text == "no_service") type = ZoneType::NO_SERVICE;
+        else if (text == "special_fare") type = ZoneType::SPECIAL_FARE;
+        else return false;
+        return true;
+    }
+
+    static bool parseVehicleMask(const string& text, uint8_t& mask) {
+        if (text == "all") {
+            mask = ALL_VEHICLE_TYPES;
+            return true;
+        }
+        mask = 0;
+        stringstream list(text);
+        string item;
+        while (getline(list, item, ',')) {
+            if (item == "bike") mask |= vehicleTypeBit(VehicleType::BIKE);
+            else if (item == "sedan") mask |= vehicleTypeBit(VehicleType::SEDAN);
+            else if (item == "suv") mask |= vehicleTypeBit(VehicleType::SUV);
+            else if (item == "auto") mask |= vehicleTypeBit(VehicleType::AUTO_RICKSHAW);
+            else return false;
+        }
+        return mask != 0;
+    }
+
+public:
+    GeofenceIndex() : root(0), height(0), hasServiceAreas(false) {}
+
+    // Returns the zone's index; the zone is not searchable until build()
+    size_t addZone(const string& zoneId, const string& name, ZoneType type,
+                   const vector<Location>& vertices, double pickupSurcharge = 0.0,
+                   uint8_t allowedVehicles = ALL_VEHICLE_TYPES) {
+        GeoZone zone;
+        zone.zoneId = zoneId;
+        zone.name = name;
+        zone.type = type;
+        zone.pickupSurcharge = pickupSurcharge;
+        zone.allowedVehicles = allowedVehicles;
+        zone.polygon = GeoPolygon(vertices);
+        zones.push_back(move(zone));
+        return zones.size() - 1;
+    }
+
+    void build() {
+        nodes.clear();
+        height = 0;
+        hasServiceAreas = false;
+
+        vector<Entry> entries;
+        entries.reserve(zones.size());
+        for (size_t i = 0; i < zones.size(); i++) {
+            if (zones[i].polygon.getVertexCount() < 3) continue;
+            Entry e;
+            e.box = zones[i].polygon.getBounds();
+            e.id = static_cast<uint32_t>(i);
+            entries.push_back(e);
+            if (zones[i].type == ZoneType::SERVICE_AREA) hasServiceAreas = true;
+        }
+        if (entries.empty()) return;
+
+        bool leaf = true;
+        do {
+            entries = packLevel(entries, leaf);
+            leaf = false;
+            height++;
+        } while (entries.size() > 1);
+        root = entries[0].id;
+    }
+
+    // Text format, one zone per block ('#' starts a comment line):
+    //   zone <id> <service_area|no_service|special_fare> <surcharge> <all|bike,sedan,suv,auto> <name...>
+    //   <lat> <lng>          (one line per vertex, at least three)
+    //   end
+    // Adds the zones and rebuilds the index; on a malformed file nothing is
+    // added and 'error' names the offending line.
+    bool load(istream& in, string& error) {
+        vector<GeoZone> parsed;
+        vector<Location> vertices;
+        GeoZone current;
+        bool inZone = false;
+        string line;
+        size_t lineNumber = 0;
+
+        auto fail = [&](const string& what) {
+            error = "line " + to_string(lineNumber) + ": " + what;
+            return false;
+        };
+
+        while (getline(in, line)) {
+            lineNumber++;
+            stringstream fields(line);
+            string first;
+            if (!(fields >> first) || first[0] == '#') continue;
+
+            if (first == "zone") {
+                if (inZone) return fail("missing 'end' before new zone");
+                string idText, typeText, vehicleText;
+                if (!(fields >> idText >> typeText >> current.pickupSurcharge >> vehicleText)) {
+                    return fail("expected: zone <id> <type> <surcharge> <vehicles> <name>");
+                }
+                current.zoneId = idText;
+                if (!parseZoneType(typeText, current.type)) return fail("unknown zone type " + typeText);
+                if (!parseVehicleMask(vehicleText, current.allowedVehicles)) {
+                    return fail("unknown vehicle list " + vehicleText);
+                }
+                getline(fields >> ws, current.name);
+                if (current.name.empty()) current.name = current.zoneId.str();
+                vertices.clear();
+                inZone = true;
+            } else if (first == "end") {
+                if (!inZone) return fail("'end' without 'zone'");
+                if (vertices.size() < 3) return fail("zone " + current.zoneId.str() + " needs three vertices");
+                current.polygon = GeoPolygon(vertices);
+                parsed.push_back(current);
+                inZone = false;
+            } else {
+                if (!inZone) return fail("vertex outside a zone block");
+                stringstream coords(line);
+                double lat, lng;
+                if (!(coords >> lat >> lng)) return fail("expected: <lat> <lng>");
+                vertices.emplace_back(lat, lng);
+            }
+        }
+        if (inZone) return fail("zone " + current.zoneId.str() + " is missing 'end'");
+
+        for (auto& zone : parsed) zones.push_back(move(zone));
+        build();
+        return true;
+    }
+
+    bool loadFile(const string& path, string& error) {
+        ifstream in(path);
+        if (!in) {
+            error = "cannot open " + path;
+            return false;
+        }
+        return load(in, error);
+    }
+
+    // Calls visit(const GeoZone&) for every zone containing the location
+    template <typename Visitor>
+    void forEachZoneAt(const Location& location, Visitor visit) const {
+        if (nodes.empty()) return;
+        double lat = location.latitude;
+        double lng = location.longitude;
+
+        uint32_t stack[MAX_QUERY_STACK];
+        size_t top = 0;
+        stack[top++] = root;
+        while (top > 0) {
+            const Node& node = nodes[stack[--top]];
+            for (uint32_t mask = node.match(lat, lng); mask; mask &= mask - 1) {
+                uint32_t k = lowestBit(mask);
+                if (node.leaf) {
+                    const GeoZone& zone = zones[node.children[k]];
+                    if (zone.polygon.contains(lat, lng)) visit(zone);
+                } else if (top < MAX_QUERY_STACK) {
+                    stack[top++] = node.children[k];
+                }
+            }
+        }
+    }
+
+    // Applies service-area, no-service and vehicle restrictions to a request
+    ServiceCheck checkRequest(const Location& pickup, const Location& dropoff,
+                              VehicleType vehicleType) const {
+        ServiceCheck result;
+        bool pickupServed = !hasServiceAreas;
+        forEachZoneAt(pickup, [&](const GeoZone& zone) {
+            if (zone.type == ZoneType::SERVICE_AREA) pickupServed = true;
+            if (!result.isAllowed()) return;
+            if (zone.type == ZoneType::NO_SERVICE) {
+                result = ServiceCheck(ServiceDecision::NO_SERVICE_ZONE, zone.zoneId);
+            } else if (!zone.allows(vehicleType)) {
+                result = ServiceCheck(ServiceDecision::VEHICLE_RESTRICTED, zone.zoneId);
+            }
+        });
+        if (!pickupServed) return ServiceCheck(ServiceDecision::OUTSIDE_SERVICE_AREA);
+        if (!result.isAllowed()) return result;
+
+        bool dropoffServed = !hasServiceAreas;
+        forEachZoneAt(dropoff, [&](const GeoZone& zone) {
+            if (zone.type == ZoneType::SERVICE_AREA) dropoffServed = true;
+            if (zone.type == ZoneType::NO_SERVICE && result.isAllowed()) {
+                result = ServiceCheck(ServiceDecision::NO_SERVICE_ZONE, zone.zoneId);
+            }
+        });
+        if (!dropoffServed) return ServiceCheck(ServiceDecision::OUTSIDE_SERVICE_AREA);
+        return result;
+    }
+
+    // Highest surcharge among zones containing the pickup; overlapping zones
+    // (a terminal inside an airport) do not stack
+    double getPickupSurcharge(const Location& pickup) const {
+        double surcharge = 0.0;
+        forEachZoneAt(pickup, [&surcharge](const GeoZone& zone) {
+            surcharge = max(surcharge, zone.pickupSurcharge);
+        });
+        return surcharge;
+    }
+
+    size_t getZoneCount() const { return zones.size(); }
+    const GeoZone& getZone(size_t index) const { return zones[index]; }
+    size_t getTreeHeight() const { return height; }
+};
+
+#endif
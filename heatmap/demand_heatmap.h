@@ -0,0 +1,199 @@
+#ifndef DEMAND_HEATMAP_H
+#define DEMAND_HEATMAP_H
+
+#include "../users/driver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+struct RepositionRecommendation {
+    shared_ptr<Driver> driver;
+    size_t targetCell;
+    Location target;        // center of the target cell
+    double expectedGain;    // unmet demand in the target cell, distance-penalized
+};
+
+// Demand (pickup requests) and idle supply over a uniform lat/lng grid.
+// Demand is kept in a ring of time buckets forming a sliding window; each
+// bucket remembers which cells it touched, so expiring a bucket only costs
+// the cells that actually saw requests in it.
+class DemandHeatmap {
+private:
+    double minLatitude;
+    double minLongitude;
+    double cellSizeDegrees;
+    size_t rows;
+    size_t cols;
+
+    chrono::seconds bucketWidth;
+    size_t bucketCount;
+    int64_t currentBucket;  // absolute bucket number of the newest bucket
+
+    vector<uint32_t> demandTotal;               // per cell, across the window
+    vector<vector<uint32_t>> bucketCounts;      // [bucket][cell]
+    vector<vector<uint32_t>> bucketTouched;     // [bucket] -> cells with counts
+    vector<uint32_t> supply;                    // idle drivers per cell
+    uint64_t windowDemand;
+
+    int64_t toBucket(chrono::system_clock::time_point time) const {
+        return chrono::duration_cast<chrono::seconds>(time.time_since_epoch()).count() /
+               bucketWidth.count();
+    }
+
+    void expireBucket(size_t slot) {
+        vector<uint32_t>& counts = bucketCounts[slot];
+        for (uint32_t cell : bucketTouched[slot]) {
+            demandTotal[cell] -= counts[cell];
+            windowDemand -= counts[cell];
+            counts[cell] = 0;
+        }
+        bucketTouched[slot].clear();
+    }
+
+public:
+    // Grid covers [minLat, maxLat] x [minLng, maxLng] with square cells of
+    // cellSizeKm; the window spans bucketCount buckets of bucketWidth each
+    DemandHeatmap(double minLat, double minLng, double maxLat, double maxLng,
+                  double cellSizeKm = 0.5,
+                  chrono::seconds width = chrono::seconds(60),
+                  size_t buckets = 15)
+        : minLatitude(minLat), minLongitude(minLng),
+          cellSizeDegrees(cellSizeKm / 111.0),
+          bucketWidth(width), bucketCount(max<size_t>(1, buckets)),
+          currentBucket(-1), windowDemand(0) {
+        rows = static_cast<size_t>(ceil((maxLat - minLat) / cellSizeDegrees)) + 1;
+        cols = static_cast<size_t>(ceil((maxLng - minLng) / cellSizeDegrees)) + 1;
+
+        demandTotal.assign(rows * cols, 0);
+        supply.assign(rows * cols, 0);
+        bucketCounts.assign(bucketCount, vector<uint32_t>(rows * cols, 0));
+        bucketTouched.resize(bucketCount);
+    }
+
+    size_t getCellCount() const { return rows * cols; }
+    uint64_t getWindowDemand() const { return windowDemand; }
+    uint32_t getDemand(size_t cell) const { return demandTotal[cell]; }
+    uint32_t getSupply(size_t cell) const { return supply[cell]; }
+
+    // Points outside the grid are clamped onto its border cells. Returns false
+    // for non-finite or out-of-range coordinates, which have no cell (a NaN
+    // would survive the clamp and turn into an arbitrary index).
+    bool cellFor(const Location& loc, size_t& cell) const {
+        if (!loc.hasValidCoordinates()) return false;
+        double r = floor((loc.latitude - minLatitude) / cellSizeDegrees);
+        double c = floor((loc.longitude - minLongitude) / cellSizeDegrees);
+        size_t row = static_cast<size_t>(min(max(r, 0.0), static_cast<double>(rows - 1)));
+        size_t col = static_cast<size_t>(min(max(c, 0.0), static_cast<double>(cols - 1)));
+        cell = row * cols + col;
+        return true;
+    }
+
+    Location cellCenter(size_t cell) const {
+        size_t row = cell / cols;
+        size_t col = cell % cols;
+        return Location(minLatitude + (row + 0.5) * cellSizeDegrees,
+                        minLongitude + (col + 0.5) * cellSizeDegrees);
+    }
+
+    // Slides the window forward so that 'now' falls in the newest bucket
+    void advanceTo(chrono::system_clock::time_point now) {
+        int64_t bucket = toBucket(now);
+        if (bucket <= currentBucket) return;
+
+        if (currentBucket < 0 || bucket - currentBucket >= static_cast<int64_t>(bucketCount)) {
+            for (size_t slot = 0; slot < bucketCount; slot++) {
+                expireBucket(slot);
+            }
+        } else {
+            for (int64_t b = currentBucket + 1; b <= bucket; b++) {
+                expireBucket(static_cast<size_t>(b % bucketCount));
+            }
+        }
+        currentBucket = bucket;
+    }
+
+    // Returns false, recording nothing, for a pickup cellFor rejects
+    bool recordPickup(const Location& pickup,
+                      chrono::system_clock::time_point now = chrono::system_clock::now()) {
+        size_t cell;
+        if (!cellFor(pickup, cell)) return false;
+        advanceTo(now);
+
+        size_t slot = static_cast<size_t>(currentBucket % bucketCount);
+        if (bucketCounts[slot][cell]++ == 0) {
+            bucketTouched[slot].push_back(static_cast<uint32_t>(cell));
+        }
+        demandTotal[cell]++;
+        windowDemand++;
+        return true;
+    }
+
+    // Rebuilds idle supply from the drivers' current positions
+    void refreshSupply(const vector<shared_ptr<Driver>>& drivers) {
+        fill(supply.begin(), supply.end(), 0);
+        size_t cell;
+        for (const auto& driver : drivers) {
+            if (driver->isAvailable() && cellFor(driver->getCurrentLocation(), cell)) {
+                supply[cell]++;
+            }
+        }
+    }
+
+    // For each idle driver, picks the cell within radiusCells with the largest
+    // demand-minus-supply gap, discounted by distance. Recommendations are
+    // applied to the supply as they are made so drivers spread out instead of
+    // all heading to the same hotspot. Drivers already in the best cell are skipped.
+    vector<RepositionRecommendation> recommend(const vector<shared_ptr<Driver>>& drivers,
+                                               size_t radiusCells = 4,
+                                               double distancePenalty = 0.25) {
+        refreshSupply(drivers);
+
+        vector<RepositionRecommendation> recommendations;
+        for (const auto& driver : drivers) {
+            size_t home;
+            if (!driver->isAvailable() || !cellFor(driver->getCurrentLocation(), home)) continue;
+
+            size_t homeRow = home / cols;
+            size_t homeCol = home % cols;
+
+            size_t rowBegin = homeRow > radiusCells ? homeRow - radiusCells : 0;
+            size_t rowEnd = min(rows - 1, homeRow + radiusCells);
+            size_t colBegin = homeCol > radiusCells ? homeCol - radiusCells : 0;
+            size_t colEnd = min(cols - 1, homeCol + radiusCells);
+
+            size_t bestCell = home;
+            double bestScore = static_cast<double>(demandTotal[home]) -
+                               static_cast<double>(supply[home] - 1);
+
+            for (size_t r = rowBegin; r <= rowEnd; r++) {
+                for (size_t c = colBegin; c <= colEnd; c++) {
+                    size_t cell = r * cols + c;
+                    if (cell == home) continue;
+
+                    double gap = static_cast<double>(demandTotal[cell]) -
+                                 static_cast<double>(supply[cell]);
+                    if (gap <= 0.0) continue;
+
+                    double steps = max(r > homeRow ? r - homeRow : homeRow - r,
+                                       c > homeCol ? c - homeCol : homeCol - c);
+                    double score = gap - distancePenalty * steps;
+                    if (score > bestScore) {
+                        bestScore = score;
+                        bestCell = cell;
+                    }
+                }
+            }
+
+            if (bestCell == home) continue;
+
+            supply[home]--;
+            supply[bestCell]++;
+            recommendations.push_back({driver, bestCell, cellCenter(bestCell), bestScore});
+        }
+
+        return recommendations;
+    }
+};
+
+#endif
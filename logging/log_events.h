@@ -0,0 +1,98 @@
+#ifndef LOG_EVENTS_H
+#define LOG_EVENTS_H
+
+#include <cstdint>
+#include <cstddef>
+
+// Shared between the runtime logger and the offline decoder (tools/log_decoder.cpp).
+// Records are written as fixed-size binary blobs; only the event ID and the raw
+// arguments are stored, the human-readable text is rebuilt offline from the schema.
+
+enum class LogLevel : uint8_t {
+    DEBUG,
+    INFO,
+    WARN,
+    ERROR,
+    OFF
+};
+
+// Append new events at the end so existing log files keep decoding correctly
+enum class LogEvent : uint16_t {
+    RIDER_NOT_FOUND,
+    RIDE_CREATED,
+    NO_DRIVER_AVAILABLE,
+    DRIVER_EN_ROUTE,
+    RIDE_COMPLETED,
+    RIDE_CANCELLED,
+    RIDE_REJECTED,
+    RIDE_OFFERED,
+    OFFER_DECLINED,
+    DRIVER_STATE_DROPPED,
+    EVENT_COUNT
+};
+
+enum class LogArgType : uint8_t {
+    INT,
+    REAL,
+    TEXT
+};
+
+struct LogEventSchema {
+    const char* name;
+    const char* format;     // "{}" is replaced by the next argument
+};
+
+inline const LogEventSchema& getEventSchema(LogEvent event) {
+    static const LogEventSchema schemas[] = {
+        {"RIDER_NOT_FOUND",     "Rider {} not found!"},
+        {"RIDE_CREATED",        "Ride {} created and driver {} assigned using {}"},
+        {"NO_DRIVER_AVAILABLE", "No available drivers found for the requested vehicle type! (rider {})"},
+        {"DRIVER_EN_ROUTE",     "Driver {} is en route to pickup location for ride {}"},
+        {"RIDE_COMPLETED",      "Ride {} completed. Fare: ${} (calculated using {})"},
+        {"RIDE_CANCELLED",      "Ride {} cancelled: {}"},
+        {"RIDE_REJECTED",       "Ride request from rider {} rejected: {} ({})"},
+        {"RIDE_OFFERED",        "Ride {} offered to driver {} (candidate {} of {})"},
+        {"OFFER_DECLINED",      "Driver {} passed on ride {}: {}"},
+        {"DRIVER_STATE_DROPPED", "Shared driver table is full ({} slots); driver {} is not mirrored"}
+    };
+    static const LogEventSchema unknown = {"UNKNOWN", "Unknown event"};
+
+    size_t index = static_cast<size_t>(event);
+    if (index >= static_cast<size_t>(LogEvent::EVENT_COUNT)) return unknown;
+    return schemas[index];
+}
+
+inline const char* getLogLevelString(LogLevel level) {
+    switch (level) {
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARN: return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        default: return "OFF";
+    }
+}
+
+// On-disk layout: one LogFileHeader followed by LogRecords back to back.
+// A record payload is a sequence of [LogArgType tag][value] entries, where INT
+// and REAL values take 8 bytes and TEXT is a 1-byte length plus the characters.
+const char LOG_FILE_MAGIC[8] = {'R', 'S', 'L', 'O', 'G', '0', '1', '\0'};
+const size_t LOG_PAYLOAD_SIZE = 112;
+
+struct LogFileHeader {
+    char magic[8];
+    uint32_t recordSize;
+    uint32_t reserved;
+};
+
+struct LogRecord {
+    uint64_t timestampNs;   // system_clock, nanoseconds since epoch
+    uint32_t threadIndex;
+    uint16_t eventId;
+    uint8_t level;
+    uint8_t argCount;
+    unsigned char payload[LOG_PAYLOAD_SIZE];
+};
+
+static_assert(sizeof(LogRecord) == 128, "LogRecord must stay fixed-size");
+
+#endif
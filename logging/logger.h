@@ -0,0 +1,263 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include "log_events.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+using namespace std;
+
+// Events below this level are compiled out entirely (arguments are never evaluated)
+#ifndef LOG_COMPILED_MIN_LEVEL
+#define LOG_COMPILED_MIN_LEVEL 0
+#endif
+
+// Single-producer/single-consumer ring owned by one logging thread and drained
+// by the background flusher. The producer never blocks; a full ring drops records.
+class LogRing {
+public:
+    static const size_t CAPACITY = 4096;    // must be a power of two
+
+private:
+    LogRecord records[CAPACITY];
+    atomic<size_t> head;    // next slot the producer writes
+    atomic<size_t> tail;    // next slot the flusher reads
+    atomic<uint64_t> dropped;
+    uint32_t threadIndex;
+
+public:
+    explicit LogRing(uint32_t index) : head(0), tail(0), dropped(0), threadIndex(index) {}
+
+    uint32_t getThreadIndex() const { return threadIndex; }
+    uint64_t getDroppedCount() const { return dropped.load(memory_order_relaxed); }
+
+    LogRecord* reserve() {
+        size_t h = head.load(memory_order_relaxed);
+        if (h - tail.load(memory_order_acquire) >= CAPACITY) {
+            dropped.fetch_add(1, memory_order_relaxed);
+            return nullptr;
+        }
+        return &records[h & (CAPACITY - 1)];
+    }
+
+    void commit() {
+        head.store(head.load(memory_order_relaxed) + 1, memory_order_release);
+    }
+
+    // Called from the flusher thread only
+    size_t drainTo(FILE* sink) {
+        size_t t = tail.load(memory_order_relaxed);
+        size_t h = head.load(memory_order_acquire);
+        size_t total = h - t;
+        while (t != h) {
+            size_t start = t & (CAPACITY - 1);
+            size_t count = min(h - t, CAPACITY - start);
+            fwrite(&records[start], sizeof(LogRecord), count, sink);
+            t += count;
+        }
+        tail.store(t, memory_order_release);
+        return total;
+    }
+};
+
+// Encodes one argument into a record payload; returns false once the payload is full
+class LogArgEncoder {
+private:
+    LogRecord& record;
+    size_t offset;
+
+    bool putScalar(LogArgType type, const void* value) {
+        if (offset + 1 + 8 > LOG_PAYLOAD_SIZE) return false;
+        record.payload[offset++] = static_cast<unsigned char>(type);
+        memcpy(record.payload + offset, value, 8);
+        offset += 8;
+        record.argCount++;
+        return true;
+    }
+
+    bool putText(const char* text, size_t length) {
+        if (offset + 2 > LOG_PAYLOAD_SIZE) return false;
+        length = min(length, min<size_t>(255, LOG_PAYLOAD_SIZE - offset - 2));
+        record.payload[offset++] = static_cast<unsigned char>(LogArgType::TEXT);
+        record.payload[offset++] = static_cast<unsigned char>(length);
+        memcpy(record.payload + offset, text, length);
+        offset += length;
+        record.argCount++;
+        return true;
+    }
+
+public:
+    explicit LogArgEncoder(LogRecord& r) : record(r), offset(0) {}
+
+    template <typename T>
+    typename enable_if<is_integral<T>::value || is_enum<T>::value, bool>::type
+    put(T value) {
+        int64_t v = static_cast<int64_t>(value);
+        return putScalar(LogArgType::INT, &v);
+    }
+
+    template <typename T>
+    typename enable_if<is_floating_point<T>::value, bool>::type
+    put(T value) {
+        double v = static_cast<double>(value);
+        return putScalar(LogArgType::REAL, &v);
+    }
+
+    bool put(const string& text) { return putText(text.data(), text.size()); }
+    bool put(const char* text) { return putText(text, strlen(text)); }
+};
+
+class Logger {
+private:
+    static Logger* instance;
+    atomic<int> minLevel;
+    atomic<bool> running;
+    FILE* sink;
+    thread flusher;
+    mutex ringsMutex;
+    condition_variable flushSignal;
+    vector<shared_ptr<LogRing>> rings;
+    chrono::milliseconds flushInterval;
+
+    Logger() : minLevel(static_cast<int>(LogLevel::OFF)), running(false), sink(nullptr),
+               flushInterval(50) {}
+
+    LogRing& localRing() {
+        thread_local shared_ptr<LogRing> ring = registerRing();
+        return *ring;
+    }
+
+    shared_ptr<LogRing> registerRing() {
+        lock_guard<mutex> lock(ringsMutex);
+        auto ring = make_shared<LogRing>(static_cast<uint32_t>(rings.size()));
+        rings.push_back(ring);
+        return ring;
+    }
+
+    void drainAll() {
+        lock_guard<mutex> lock(ringsMutex);
+        for (auto& ring : rings) {
+            ring->drainTo(sink);
+        }
+        fflush(sink);
+    }
+
+    void flushLoop() {
+        while (running.load(memory_order_acquire)) {
+            {
+                unique_lock<mutex> lock(ringsMutex);
+                flushSignal.wait_for(lock, flushInterval);
+            }
+            drainAll();
+        }
+    }
+
+    static uint64_t nowNs() {
+        return static_cast<uint64_t>(chrono::duration_cast<chrono::nanoseconds>(
+            chrono::system_clock::now().time_since_epoch()).count());
+    }
+
+    static void encodeArgs(LogArgEncoder&) {}
+
+    template <typename First, typename... Rest>
+    static void encodeArgs(LogArgEncoder& encoder, const First& first, const Rest&... rest) {
+        if (encoder.put(first)) encodeArgs(encoder, rest...);
+    }
+
+public:
+    static Logger* getInstance() {
+        if (instance == nullptr) {
+            instance = new Logger();
+        }
+        return instance;
+    }
+
+    // Opens a binary log file and starts the background flusher
+    bool open(const string& path, LogLevel level = LogLevel::INFO) {
+        if (running.load()) return false;
+
+        sink = fopen(path.c_str(), "wb");
+        if (sink == nullptr) return false;
+
+        LogFileHeader header;
+        memcpy(header.magic, LOG_FILE_MAGIC, sizeof(header.magic));
+        header.recordSize = sizeof(LogRecord);
+        header.reserved = 0;
+        fwrite(&header, sizeof(header), 1, sink);
+
+        running.store(true, memory_order_release);
+        flusher = thread(&Logger::flushLoop, this);
+        setLevel(level);
+        return true;
+    }
+
+    // Stops the flusher after writing out everything still buffered
+    void close() {
+        if (!running.load()) return;
+
+        setLevel(LogLevel::OFF);
+        running.store(false, memory_order_release);
+        flushSignal.notify_all();
+        flusher.join();
+        drainAll();
+        fclose(sink);
+        sink = nullptr;
+    }
+
+    void setLevel(LogLevel level) { minLevel.store(static_cast<int>(level), memory_order_relaxed); }
+    LogLevel getLevel() const { return static_cast<LogLevel>(minLevel.load(memory_order_relaxed)); }
+
+    bool isEnabled(LogLevel level) const {
+        return static_cast<int>(level) >= minLevel.load(memory_order_relaxed);
+    }
+
+    uint64_t getDroppedCount() {
+        lock_guard<mutex> lock(ringsMutex);
+        uint64_t total = 0;
+        for (const auto& ring : rings) {
+            total += ring->getDroppedCount();
+        }
+        return total;
+    }
+
+    template <typename... Args>
+    void log(LogLevel level, LogEvent event, const Args&... args) {
+        LogRing& ring = localRing();
+        LogRecord* record = ring.reserve();
+        if (record == nullptr) return;
+
+        record->timestampNs = nowNs();
+        record->threadIndex = ring.getThreadIndex();
+        record->eventId = static_cast<uint16_t>(event);
+        record->level = static_cast<uint8_t>(level);
+        record->argCount = 0;
+
+        LogArgEncoder encoder(*record);
+        encodeArgs(encoder, args...);
+        ring.commit();
+    }
+};
+
+// Static member definition
+Logger* Logger::instance = nullptr;
+
+// Level check happens before any argument is evaluated, so a disabled event
+// costs a single relaxed load and branch
+#define LOG_EVENT(level, event, ...)                                                  \
+    do {                                                                              \
+        if ((level) >= static_cast<LogLevel>(LOG_COMPILED_MIN_LEVEL) &&               \
+            Logger::getInstance()->isEnabled(level)) {                                \
+            Logger::getInstance()->log(level, event, __VA_ARGS__);                    \
+        }                                                                             \
+    } while (0)
+
+#endif
@@ -3,10 +3,18 @@
 #include "strategies/matching_strategy.h"
 #include "observers/notification_observer.h"
 #include "pricing/fare_calculator.h"
+#include "logging/logger.h"
+#include "analytics/ride_analytics.h"
+#include "heatmap/demand_heatmap.h"
+#include "shm/shared_driver_table.h"
+#include "geofence/geofence_index.h"
 
 int main() {
     cout << "=== RIDESHARE SYSTEM SIMULATION ===" << endl;
     
+    // Ride lifecycle events go to a binary log (decode with tools/log_decoder)
+    Logger::getInstance()->open("rideshare.log", LogLevel::DEBUG);
+    
     // Get singleton instance
     RideManager* rideManager = RideManager::getInstance();
     
@@ -47,6 +55,16 @@ int main() {
     auto rider2 = make_shared<Rider>("R002", "Netra Mohekar", "9123456790", 
                                    Location(19.1197, 72.9073, "Andheri"), 4.7);
     
+    // Track pickup demand over a 0.5 km grid of Mumbai with a 15 minute window
+    rideManager->setDemandHeatmap(make_shared<DemandHeatmap>(18.90, 72.77, 19.30, 73.05));
+    
+    // Mirror driver state into shared memory for other local processes
+    // (inspect it with tools/driver_state_reader while the simulation runs)
+    shared_ptr<SharedDriverTable> driverTable = SharedDriverTable::create("/rideshare_drivers", 1024);
+    if (driverTable) {
+        rideManager->setSharedDriverTable(driverTable);
+    }
+    
     // Add users to system
     rideManager->addDriver(driver1);
     rideManager->addDriver(driver2);
@@ -158,10 +176,208 @@ int main() {
     driver3->setStatus(DriverStatus::AVAILABLE);
     driver4->setStatus(DriverStatus::AVAILABLE);
     
+    cout << "\n=== SCENARIO 6: Repositioning Idle Drivers (Demand Heatmap) ===" << endl;
+    
+    for (const auto& recommendation : rideManager->recommendRepositioning()) {
+        cout << "Driver " << recommendation.driver->getName() << " should move to ("
+             << recommendation.target.latitude << ", " << recommendation.target.longitude
+             << "), expected gain " << recommendation.expectedGain << endl;
+    }
+    
+    cout << "\n=== SCENARIO 7: Cancellation and Lifecycle Timeouts ===" << endl;
+    
+    // Rider cancels while the driver is on the way
+    Location pickup7(19.0896, 72.8656, "Dadar West");
+    Location dropoff7(19.0544, 72.8322, "Colaba");
+    
+    auto ride7 = rideManager->requestRide("R002", pickup7, dropoff7, VehicleType::SEDAN);
+    if (ride7) {
+        rideManager->driverEnRoute(ride7->getRideId());
+        rideManager->cancelRide(ride7->getRideId());
+        cout << "Ride " << ride7->getRideId() << ": " << ride7->getCancellationReasonString() << endl;
+    }
+    
+    // Assigned driver never starts moving; the assignment deadline cancels the ride.
+    // Skipping ahead moves the manager's clock too, so later deadlines are
+    // armed from the skipped-to time rather than firing early.
+    auto ride8 = rideManager->requestRide("R001", pickup7, dropoff7, VehicleType::SEDAN);
+    if (ride8) {
+        rideManager->processTimeouts(rideManager->currentTime() + chrono::minutes(5));
+        cout << "Ride " << ride8->getRideId() << ": " << ride8->getCancellationReasonString() << endl;
+    }
+    
+    cout << "\n=== SCENARIO 8: Service Areas and Airport Surcharge (Geofence) ===" << endl;
+    
+    // City service polygon, an airport pickup zone and a no-service zone
+    auto zones = make_shared<GeofenceIndex>();
+    zones->addZone("MUM", "Mumbai Service Area", ZoneType::SERVICE_AREA,
+                   {Location(18.89, 72.80), Location(18.89, 72.86), Location(19.05, 72.95),
+                    Location(19.30, 73.05), Location(19.30, 72.77), Location(19.05, 72.79)});
+    zones->addZone("BOM", "Mumbai Airport", ZoneType::SPECIAL_FARE,
+                   {Location(19.0860, 72.8550), Location(19.0860, 72.8780),
+                    Location(19.1000, 72.8780), Location(19.1000, 72.8550)},
+                   150.0, vehicleTypeBit(VehicleType::SEDAN) | vehicleTypeBit(VehicleType::SUV));
+    zones->addZone("SGNP", "National Park", ZoneType::NO_SERVICE,
+                   {Location(19.20, 72.88), Location(19.20, 72.94),
+                    Location(19.26, 72.94), Location(19.26, 72.88)});
+    zones->build();
+    
+    rideManager->setGeofence(zones);
+    rideManager->setFareCalculator(make_unique<ZoneSurchargeDecorator>(
+        make_unique<BaseFareCalculator>(), zones));
+    
+    Location airport(19.0920, 72.8680, "Airport Terminal 2");
+    Location dropoff8(19.0544, 72.8322, "Colaba");
+    
+    auto ride9 = rideManager->requestRide("R001", airport, dropoff8, VehicleType::SEDAN);
+    if (ride9) {
+        rideManager->startRide(ride9->getRideId());
+        rideManager->completeRide(ride9->getRideId());
+    }
+    
+    struct ZoneRequest {
+        const char* label;
+        Location pickup;
+        VehicleType vehicleType;
+    };
+    const ZoneRequest rejected[] = {
+        {"Auto rickshaw from the airport", airport, VehicleType::AUTO_RICKSHAW},
+        {"Pickup in Pune", Location(18.5204, 73.8567, "Pune"), VehicleType::SEDAN},
+        {"Pickup inside the national park", Location(19.2300, 72.9100, "Borivali East"), VehicleType::SEDAN}
+    };
+    for (const auto& request : rejected) {
+        ServiceCheck check = zones->checkRequest(request.pickup, dropoff8, request.vehicleType);
+        auto ride = rideManager->requestRide("R002", request.pickup, dropoff8, request.vehicleType);
+        cout << request.label << ": " << (ride ? "accepted" : "rejected") << " ("
+             << check.getDecisionString() << ")" << endl;
+    }
+    
+    cout << "\n=== SCENARIO 9: GPS Trace and Traced-Distance Billing ===" << endl;
+    
+    // Bill on the route actually driven instead of the straight line
+    rideManager->setFareCalculator(make_unique<BaseFareCalculator>(50.0, 10.0, FareDistance::TRACED_PATH));
+    
+    Location pickup9(19.0596, 72.8295, "Bandra Bandstand");
+    Location dropoff9(19.0000, 72.8150, "Worli Sea Face");
+    
+    auto ride10 = rideManager->requestRide("R002", pickup9, dropoff9, VehicleType::SEDAN);
+    if (ride10) {
+        rideManager->startRide(ride10->getRideId());
+        
+        // Driver reports a fix every second at about 30 km/h along a winding route
+        const Location waypoints[] = {pickup9, Location(19.0400, 72.8400), Location(19.0178, 72.8478),
+                                      dropoff9};
+        const string& driverId = ride10->getDriver()->getUserId();
+        auto fixTime = chrono::system_clock::now();
+        for (size_t leg = 0; leg + 1 < sizeof(waypoints) / sizeof(waypoints[0]); leg++) {
+            const Location& from = waypoints[leg];
+            const Location& to = waypoints[leg + 1];
+            int steps = static_cast<int>(from.distanceTo(to) * 1000.0 / 8.3);
+            for (int i = 0; i < steps; i++) {
+                double t = static_cast<double>(i) / steps;
+                rideManager->updateDriverLocation(driverId,
+                    Location(from.latitude + t * (to.latitude - from.latitude),
+                             from.longitude + t * (to.longitude - from.longitude)), fixTime);
+                fixTime += chrono::seconds(1);
+            }
+        }
+        rideManager->updateDriverLocation(driverId, dropoff9, fixTime);
+        rideManager->completeRide(ride10->getRideId());
+        
+        const GpsTrace& trace = ride10->getTrace();
+        cout << "Recorded " << trace.getPointCount() << " points in " << trace.getEncodedBytes()
+             << " bytes (" << trace.getBytesPerPoint() << " bytes/point vs "
+             << sizeof(TracePoint) << " raw)" << endl;
+        cout << "Traced distance: " << trace.getPathLengthKm() << " km (decoded: "
+             << trace.computePathLengthKm() << " km), straight line: "
+             << ride10->getDistance() << " km" << endl;
+        cout << "Fare billed on traced distance: $" << ride10->getFare() << endl;
+    }
+    
+    cout << "\n=== SCENARIO 10: Offer Cascade with Accept/Decline ===" << endl;
+    
+    // Two more sedans near Lower Parel; rides are now offered to the three
+    // nearest sedans in turn, 15 seconds each, instead of being force-assigned
+    rideManager->addDriver(make_shared<Driver>("D005", "Sanjay Patil", "9876543214",
+        Location(19.0050, 72.8310, "Lower Parel"),
+        VehicleFactory::createVehicle(VehicleType::SEDAN, "V005", "MH01JK7890"), 4.5));
+    rideManager->addDriver(make_shared<Driver>("D006", "Imran Shaikh", "9876543215",
+        Location(19.0100, 72.8350, "Prabhadevi"),
+        VehicleFactory::createVehicle(VehicleType::SEDAN, "V006", "MH01LM2345"), 4.8));
+    rideManager->setOfferPolicy(OfferPolicy(3, chrono::seconds(15)));
+    
+    Location pickup10(19.0030, 72.8300, "Phoenix Mills");
+    Location dropoff10(19.0596, 72.8295, "Bandra Bandstand");
+    
+    auto ride11 = rideManager->requestRide("R001", pickup10, dropoff10, VehicleType::SEDAN);
+    if (ride11) {
+        const string rideId = ride11->getRideId();
+        
+        // Nearest driver declines, the next lets the offer expire, the third accepts
+        rideManager->declineOffer(rideId, rideManager->getOfferedDriver(rideId)->getUserId());
+        auto offerClock = rideManager->currentTime() + chrono::seconds(20);
+        rideManager->processTimeouts(offerClock);
+        rideManager->acceptOffer(rideId, rideManager->getOfferedDriver(rideId)->getUserId(),
+                                 offerClock + chrono::seconds(4));
+        
+        rideManager->startRide(rideId);
+        rideManager->completeRide(rideId);
+        
+        const OfferStats& offers = rideManager->getOfferStats();
+        cout << "Offers sent: " << offers.offersSent << ", accepted: " << offers.accepted
+             << ", declined: " << offers.declined << ", expired: " << offers.expired
+             << " (decline rate " << offers.getDeclineRate() * 100.0 << "%)" << endl;
+        cout << "Offer-to-accept latency: avg " << offers.getAverageAcceptLatencyMs()
+             << " ms, max " << offers.maxAcceptLatency.count() / 1000.0 << " ms" << endl;
+    }
+    rideManager->setOfferPolicy(OfferPolicy());
+    
+    cout << "\n=== RIDE ANALYTICS ===" << endl;
+    
+    // Export completed rides into columnar batches and run the reports
+    RideColumnStore rideStore;
+    rideStore.appendCompleted(rideManager->getRides());
+    RideAnalytics analytics(rideStore);
+    
+    vector<GroupAggregate> revenue = analytics.revenueByVehicleTypeAndHour();
+    const char* vehicleNames[] = {"Bike", "Sedan", "SUV", "Auto-Rickshaw"};
+    static_assert(sizeof(vehicleNames) / sizeof(vehicleNames[0]) == VEHICLE_TYPE_COUNT,
+                  "one name per VehicleType");
+    for (size_t type = 0; type < RideAnalytics::VEHICLE_TYPE_COUNT; type++) {
+        for (size_t hour = 0; hour < RideAnalytics::HOURS_PER_DAY; hour++) {
+            const GroupAggregate& group = revenue[type * RideAnalytics::HOURS_PER_DAY + hour];
+            if (group.count == 0) continue;
+            cout << "Revenue " << vehicleNames[type] << " @ " << hour << ":00 UTC: $"
+                 << group.sum << " (" << group.count << " rides)" << endl;
+        }
+    }
+    
+    vector<GroupAggregate> surge = analytics.fareBySurgeState();
+    cout << "Average fare without surge: $" << surge[0].average() << endl;
+    cout << "Average fare with surge: $" << surge[1].average() << endl;
+    
+    // Read driver state back the way another process would
+    auto driverTableReader = SharedDriverTable::openReadOnly("/rideshare_drivers");
+    if (driverTableReader) {
+        cout << "\n=== SHARED DRIVER TABLE ===" << endl;
+        driverTableReader->forEachDriver([](const DriverSnapshot& snapshot) {
+            cout << snapshot.driverId << " status "
+                 << (snapshot.status == DriverStatus::AVAILABLE ? "Available" : "Busy")
+                 << " at (" << snapshot.latitude << ", " << snapshot.longitude
+                 << ") version " << snapshot.version << endl;
+        });
+    }
+    
     // Final system status
     cout << "\n=== FINAL SYSTEM STATUS ===" << endl;
     rideManager->printSystemStatus();
     
+    // Dropping the writer's table unlinks the shared-memory segment
+    rideManager->setSharedDriverTable(nullptr);
+    driverTable.reset();
+    
+    Logger::getInstance()->close();
+    
     cout << "\n=== SIMULATION COMPLETED ===" << endl;
     
     return 0;
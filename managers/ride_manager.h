@@ -7,25 +7,148 @@
 #include "../strategies/matching_strategy.h"
 #include "../observers/notification_observer.h"
 #include "../pricing/fare_calculator.h"
+#include "../logging/logger.h"
+#include "../heatmap/demand_heatmap.h"
+#include "../timers/timer_wheel.h"
+#include "../concurrency/rcu_cell.h"
+#include "../config/dispatch_config.h"
+#include "../shm/shared_driver_table.h"
+#include "../geofence/geofence_index.h"
 #include <vector>
 #include <unordered_map>
 #include <algorithm>
 
+// Deadlines after which a stuck ride is cancelled and its driver released
+struct RideTimeoutPolicy {
+    chrono::seconds assignmentTimeout;  // assigned driver must start towards pickup
+    chrono::seconds pickupGrace;        // allowed overrun on top of the pickup ETA
+    double pickupSpeedKmph;             // used to estimate the pickup ETA
+    chrono::seconds noShowTimeout;      // rider must board after the driver arrives
+
+    RideTimeoutPolicy()
+        : assignmentTimeout(120), pickupGrace(300), pickupSpeedKmph(20.0), noShowTimeout(300) {}
+};
+
+// Offer cascade: the matching strategy ranks up to candidateCount drivers in
+// one pass and the ride is offered to them one at a time
+struct OfferPolicy {
+    size_t candidateCount;          // 0 assigns the best driver directly, without offers
+    chrono::seconds offerTimeout;   // unanswered offers pass to the next candidate
+
+    OfferPolicy(size_t candidates = 0, chrono::seconds timeout = chrono::seconds(15))
+        : candidateCount(candidates), offerTimeout(timeout) {}
+};
+
+struct OfferStats {
+    uint64_t offersSent;
+    uint64_t accepted;
+    uint64_t declined;
+    uint64_t expired;       // offers that timed out
+    uint64_t skipped;       // ranked candidates taken by another ride before their turn
+    uint64_t exhausted;     // rides cancelled because no candidate accepted
+    chrono::microseconds totalAcceptLatency;    // offer sent -> accepted
+    chrono::microseconds maxAcceptLatency;
+
+    OfferStats()
+        : offersSent(0), accepted(0), declined(0), expired(0), skipped(0), exhausted(0),
+          totalAcceptLatency(0), maxAcceptLatency(0) {}
+
+    // Share of answered or expired offers that were not accepted
+    double getDeclineRate() const {
+        uint64_t resolved = accepted + declined + expired;
+        return resolved ? static_cast<double>(declined + expired) / resolved : 0.0;
+    }
+
+    double getAverageAcceptLatencyMs() const {
+        return accepted ? totalAcceptLatency.count() / 1000.0 / accepted : 0.0;
+    }
+};
+
+// How much finished-ride state the manager keeps. Completed and cancelled
+// rides stay in getRides() for lookups until 'finishedRides' newer ones have
+// finished; the oldest is then evicted and its storage returns to the pools.
+// 0 keeps everything, so memory (and allocation) grows with every ride.
+struct RideRetentionPolicy {
+    size_t finishedRides;       // finished rides kept in the ride map; 0 keeps all
+    size_t historyPerUser;      // ride ids kept per rider and driver history; 0 keeps all
+
+    RideRetentionPolicy(size_t rides = 0, size_t history = 0)
+        : finishedRides(rides), historyPerUser(history) {}
+};
+
+// Why requestRide returned nullptr
+enum class RequestFailure {
+    NONE,
+    RIDER_NOT_FOUND,
+    NOT_SERVICEABLE,        // rejected by the geofence; see 'service'
+    NO_DRIVER_AVAILABLE
+};
+
+struct RideRequestOutcome {
+    RequestFailure failure;
+    ServiceCheck service;
+
+    RideRequestOutcome(RequestFailure f = RequestFailure::NONE, ServiceCheck check = ServiceCheck())
+        : failure(f), service(check) {}
+};
+
+struct RideTimeout {
+    string rideId;
+    CancellationReason reason;
+
+    RideTimeout(const string& id = "", CancellationReason r = CancellationReason::NONE)
+        : rideId(id), reason(r) {}
+};
+
+// Not thread-safe: rides, drivers, offers, timers and the retention ring
+// assume a single caller (the ride server's event loop, or main). The one
+// exception is the dispatch config, which lives in an RCU cell: snapshot
+// reads, the config setters and reclaimRetiredConfigs may run on any thread.
 class RideManager {
 private:
     static RideManager* instance;
     vector<shared_ptr<Rider>> riders;
     vector<shared_ptr<Driver>> drivers;
-    unordered_map<string, shared_ptr<Ride>> rides;
+    unordered_map<string, shared_ptr<Driver>> driversById;   // for location updates
+    RideMap rides;
+    RideRetentionPolicy retentionPolicy;
+    vector<string> finishedRideIds;     // ring of retained finished rides, oldest at finishedHead
+    size_t finishedHead;
+    
+    // Ride waiting for a driver to accept; candidates were ranked once at request time
+    struct PendingOffer {
+        vector<shared_ptr<Driver>> candidates;      // best first
+        size_t nextCandidate;
+        shared_ptr<Driver> offeredDriver;
+        chrono::steady_clock::time_point offeredAt;
+        
+        PendingOffer() : nextCandidate(0) {}
+    };
+    typedef unordered_map<string, PendingOffer, hash<string>, equal_to<string>,
+                          PoolAllocator<pair<const string, PendingOffer>>> OfferMap;
+    OfferMap pendingOffers;
+    vector<vector<shared_ptr<Driver>>> spareCandidateLists;   // recycled PendingOffer::candidates
+    OfferPolicy offerPolicy;
+    OfferStats offerStats;
+    vector<DriverCandidate> rankedDrivers;          // scratch buffer reused per request
     vector<shared_ptr<NotificationObserver>> observers;
-    unique_ptr<MatchingStrategy> matchingStrategy;
-    unique_ptr<FareCalculator> fareCalculator;
+    RcuCell<DispatchConfig> dispatchConfig;    // read lock-free on the request path
+    mutex configWriteMutex;                     // serializes read-modify-publish of the config
+    shared_ptr<DemandHeatmap> demandHeatmap;
+    shared_ptr<const GeofenceIndex> geofence;         // service areas and special-fare zones
+    shared_ptr<SharedDriverTable> driverStateTable;    // mirrored for other processes
+    uint64_t droppedDriverStates;                       // updates the full table refused
+    TimerWheel<RideTimeout> timeoutWheel;
+    chrono::steady_clock::time_point latestProcessedTime;  // furthest time processTimeouts reached
+    RideTimeoutPolicy timeoutPolicy;
+    vector<shared_ptr<Driver>> availableDrivers;    // scratch buffer reused per request
     int rideCounter;
 
-    RideManager() : rideCounter(1) {
-        matchingStrategy = make_unique<NearestDriverStrategy>();
-        fareCalculator = make_unique<BaseFareCalculator>();
-    }
+    RideManager()
+        : finishedHead(0),
+          dispatchConfig(make_unique<DispatchConfig>(make_shared<NearestDriverStrategy>(),
+                                                     make_shared<BaseFareCalculator>(), 1)),
+          droppedDriverStates(0), rideCounter(1) {}
 
 public:
     static RideManager* getInstance() {
@@ -35,6 +158,35 @@ public:
         return instance;
     }
     
+private:
+    void armTimeout(const shared_ptr<Ride>& ride, chrono::steady_clock::duration delay,
+                    CancellationReason reason) {
+        armTimeoutAt(ride, currentTime() + delay, reason);
+    }
+    
+    void armTimeoutAt(const shared_ptr<Ride>& ride, chrono::steady_clock::time_point deadline,
+                      CancellationReason reason) {
+        timeoutWheel.cancel(ride->getTimeoutTimer());
+        ride->setTimeoutTimer(timeoutWheel.schedule(deadline, RideTimeout(ride->getRideId(), reason)));
+    }
+    
+    void clearTimeout(const shared_ptr<Ride>& ride) {
+        timeoutWheel.cancel(ride->getTimeoutTimer());
+        ride->setTimeoutTimer(INVALID_TIMER_ID);
+    }
+    
+    // A full table cannot take new drivers; each refused update is counted and
+    // the first one logged, so missing drivers do not go unnoticed
+    void publishDriverState(const shared_ptr<Driver>& driver) {
+        if (driverStateTable && driver && !driverStateTable->publish(*driver)) {
+            if (droppedDriverStates++ == 0) {
+                LOG_EVENT(LogLevel::WARN, LogEvent::DRIVER_STATE_DROPPED,
+                          driverStateTable->getCapacity(), driver->getUserId());
+            }
+        }
+    }
+
+public:
     // User Management
     void addRider(shared_ptr<Rider> rider) {
         riders.push_back(rider);
@@ -42,6 +194,44 @@ public:
     
     void addDriver(shared_ptr<Driver> driver) {
         drivers.push_back(driver);
+        driversById[driver->getUserId()] = driver;
+        publishDriverState(driver);
+    }
+    
+    // Shared-memory mirror of driver state; RideManager is its only writer
+    void setSharedDriverTable(shared_ptr<SharedDriverTable> table) {
+        driverStateTable = table;
+        droppedDriverStates = 0;
+        syncDriverStates();
+    }
+    
+    // Driver updates the shared table refused because it was full
+    uint64_t getDroppedDriverStateCount() const { return droppedDriverStates; }
+    
+    // Republishes every driver, e.g. after statuses were changed directly on Driver
+    void syncDriverStates() {
+        for (const auto& driver : drivers) {
+            publishDriverState(driver);
+        }
+    }
+    
+    // Pre-sizes ride storage, pools and per-user histories so the request ->
+    // start -> complete path stops allocating once warmed up. Without a
+    // retention policy that only lasts until 'rideCapacity' rides exist; with
+    // one, size it for the retained finished rides plus the most rides ever
+    // active at once, and ridesPerUser for historyPerUser.
+    void reserveRideCapacity(size_t rideCapacity, size_t ridesPerUser = 0) {
+        rides.reserve(rideCapacity);
+        BlockPool::reserveAll(rideCapacity);
+        timeoutWheel.reserve(rideCapacity);
+        availableDrivers.reserve(drivers.size());
+        pendingOffers.reserve(drivers.size());
+        spareCandidateLists.reserve(drivers.size());
+        
+        if (ridesPerUser > 0) {
+            for (auto& rider : riders) rider->reserveRideHistory(ridesPerUser);
+            for (auto& driver : drivers) driver->reserveRideHistory(ridesPerUser);
+        }
     }
     
     // Observer Management
@@ -57,12 +247,99 @@ public:
     }
     
     // Strategy Management
+    // Each change publishes a new immutable DispatchConfig; requests already
+    // running finish on the version they started with, and the replaced
+    // version is freed once they are done. Safe to call under live traffic.
     void setMatchingStrategy(unique_ptr<MatchingStrategy> strategy) {
-        matchingStrategy = move(strategy);
+        lock_guard<mutex> lock(configWriteMutex);
+        shared_ptr<FareCalculator> calculator = dispatchConfig.read()->fareCalculator;
+        publishConfig(move(strategy), calculator);
     }
     
     void setFareCalculator(unique_ptr<FareCalculator> calculator) {
-        fareCalculator = move(calculator);
+        lock_guard<mutex> lock(configWriteMutex);
+        shared_ptr<MatchingStrategy> strategy = dispatchConfig.read()->matchingStrategy;
+        publishConfig(strategy, move(calculator));
+    }
+    
+    // Swaps strategy and pricing together so no request sees a mix of the two
+    void setDispatchConfig(unique_ptr<MatchingStrategy> strategy,
+                           unique_ptr<FareCalculator> calculator) {
+        lock_guard<mutex> lock(configWriteMutex);
+        publishConfig(move(strategy), move(calculator));
+    }
+    
+    uint64_t getDispatchConfigVersion() const {
+        return dispatchConfig.read()->version;
+    }
+    
+    // Frees replaced configs whose last readers have finished since the swap;
+    // call periodically (the ride server does so on every loop iteration).
+    // Returns how many were freed.
+    size_t reclaimRetiredConfigs() {
+        return dispatchConfig.reclaim();
+    }
+    
+    size_t getRetiredConfigCount() {
+        return dispatchConfig.getPendingReclaimCount();
+    }
+    
+private:
+    // Caller holds configWriteMutex
+    void publishConfig(shared_ptr<MatchingStrategy> strategy,
+                       shared_ptr<FareCalculator> calculator) {
+        uint64_t version = dispatchConfig.read()->version + 1;
+        dispatchConfig.publish(make_unique<DispatchConfig>(strategy, calculator, version));
+    }
+
+public:
+    
+    void setTimeoutPolicy(const RideTimeoutPolicy& policy) {
+        timeoutPolicy = policy;
+    }
+    
+    // Applies to rides finishing from now on; rides finished while
+    // finishedRides was 0 are not tracked and stay in the map
+    void setRetentionPolicy(const RideRetentionPolicy& policy) {
+        vector<string> retained;
+        retained.reserve(finishedRideIds.size());
+        for (size_t i = 0; i < finishedRideIds.size(); i++) {
+            retained.push_back(finishedRideIds[(finishedHead + i) % finishedRideIds.size()]);
+        }
+        
+        retentionPolicy = policy;
+        finishedRideIds.clear();
+        finishedRideIds.reserve(policy.finishedRides);
+        finishedHead = 0;
+        size_t evict = retained.size() > policy.finishedRides
+            ? retained.size() - policy.finishedRides : 0;
+        for (size_t i = 0; i < retained.size(); i++) {
+            if (i < evict) rides.erase(retained[i]);
+            else finishedRideIds.push_back(retained[i]);
+        }
+    }
+    
+    // Rides already waiting on an offer keep the candidates they were ranked with
+    void setOfferPolicy(const OfferPolicy& policy) {
+        offerPolicy = policy;
+    }
+    
+    const OfferStats& getOfferStats() const { return offerStats; }
+    
+    // Demand Tracking
+    void setDemandHeatmap(shared_ptr<DemandHeatmap> heatmap) {
+        demandHeatmap = heatmap;
+    }
+    
+    // Requests are checked against these zones before matching; nullptr disables the check
+    void setGeofence(shared_ptr<const GeofenceIndex> zones) {
+        geofence = zones;
+    }
+    
+    vector<RepositionRecommendation> recommendRepositioning(size_t radiusCells = 4) {
+        if (!demandHeatmap) return {};
+        demandHeatmap->advanceTo(chrono::system_clock::now());
+        return demandHeatmap->recommend(drivers, radiusCells);
     }
     
     // Core Ride Operations
@@ -70,7 +347,9 @@ public:
                                const Location& pickup,
                                const Location& dropoff,
                                VehicleType vehicleType,
-                               RideType rideType = RideType::NORMAL) {
+                               RideType rideType = RideType::NORMAL,
+                               RideRequestOutcome* outcome = nullptr) {
+        if (outcome) *outcome = RideRequestOutcome();
         
         // Find rider
         auto riderIt = find_if(riders.begin(), riders.end(),
@@ -79,101 +358,435 @@ public:
             });
         
         if (riderIt == riders.end()) {
-            cout << "Rider not found!" << endl;
+            LOG_EVENT(LogLevel::WARN, LogEvent::RIDER_NOT_FOUND, riderId);
+            if (outcome) *outcome = RideRequestOutcome(RequestFailure::RIDER_NOT_FOUND);
             return nullptr;
         }
         
+        // Reject requests outside the service area, from no-service zones, or
+        // for a vehicle type the pickup zone does not allow
+        if (geofence) {
+            ServiceCheck check = geofence->checkRequest(pickup, dropoff, vehicleType);
+            if (!check.isAllowed()) {
+                LOG_EVENT(LogLevel::WARN, LogEvent::RIDE_REJECTED, riderId, check.getDecisionString(),
+                          check.zoneId.empty() ? "-" : check.zoneId.str().c_str());
+                if (outcome) *outcome = RideRequestOutcome(RequestFailure::NOT_SERVICEABLE, check);
+                return nullptr;
+            }
+        }
+        
+        // Record demand before matching so unserved requests still count
+        if (demandHeatmap) {
+            demandHeatmap->recordPickup(pickup);
+        }
+        
         // Create ride
         string rideId = "RIDE_" + to_string(rideCounter++);
-        auto ride = make_shared<Ride>(rideId, *riderIt, pickup, dropoff, vehicleType, rideType);
+        auto ride = allocate_shared<Ride>(PoolAllocator<Ride>(), rideId, *riderIt,
+                                          pickup, dropoff, vehicleType, rideType);
+        
+        // Pin the dispatch config for the rest of this request
+        auto config = dispatchConfig.read();
         
         // Find available driver
-        vector<shared_ptr<Driver>> availableDrivers;
+        availableDrivers.clear();
         for (const auto& driver : drivers) {
             if (driver->isAvailable()) {
                 availableDrivers.push_back(driver);
             }
         }
         
-        auto assignedDriver = matchingStrategy->findBestDriver(availableDrivers, *ride);
+        // With offers enabled, rank the candidates once; the ride stays REQUESTED
+        // until one of them accepts
+        if (offerPolicy.candidateCount > 0) {
+            config->matchingStrategy->rankDrivers(availableDrivers, *ride,
+                                                  offerPolicy.candidateCount, rankedDrivers);
+            if (rankedDrivers.empty()) {
+                LOG_EVENT(LogLevel::WARN, LogEvent::NO_DRIVER_AVAILABLE, riderId);
+                if (outcome) *outcome = RideRequestOutcome(RequestFailure::NO_DRIVER_AVAILABLE);
+                return nullptr;
+            }
+            
+            PendingOffer& offer = pendingOffers[rideId];
+            if (!spareCandidateLists.empty()) {
+                offer.candidates = move(spareCandidateLists.back());
+                spareCandidateLists.pop_back();
+            }
+            for (const auto& candidate : rankedDrivers) {
+                offer.candidates.push_back(candidate.driver);
+            }
+            rides[rideId] = ride;
+            offerToNextCandidate(ride, offer, currentTime());
+            return ride;
+        }
+        
+        auto assignedDriver = config->matchingStrategy->findBestDriver(availableDrivers, *ride);
         
         if (assignedDriver) {
-            ride->setDriver(assignedDriver);
-            ride->setStatus(RideStatus::DRIVER_ASSIGNED);
-            assignedDriver->setStatus(DriverStatus::ON_TRIP);
-            
             rides[rideId] = ride;
-            
-            // Notify observers
-            notifyDriverAssigned(ride);
-            notifyRideStatusChanged(ride);
-            
-            cout << "Ride " << rideId << " created and driver " 
-                 << assignedDriver->getName() << " assigned using " 
-                 << matchingStrategy->getStrategyName() << endl;
+            assignDriver(ride, assignedDriver, config->matchingStrategy->getStrategyName());
         } else {
-            cout << "No available drivers found for the requested vehicle type!" << endl;
+            LOG_EVENT(LogLevel::WARN, LogEvent::NO_DRIVER_AVAILABLE, riderId);
+            if (outcome) *outcome = RideRequestOutcome(RequestFailure::NO_DRIVER_AVAILABLE);
             return nullptr;
         }
         
         return ride;
     }
     
-    void startRide(const string& rideId) {
+    // Offered driver takes the ride. Returns false if the ride has no
+    // outstanding offer for this driver (already answered, expired or cancelled).
+    bool acceptOffer(const string& rideId, const string& driverId) {
+        return acceptOffer(rideId, driverId, currentTime());
+    }
+    
+    // 'now' is on the manager's clock (see currentTime)
+    bool acceptOffer(const string& rideId, const string& driverId,
+                     chrono::steady_clock::time_point now) {
+        auto offerIt = findOffer(rideId, driverId);
+        if (offerIt == pendingOffers.end()) return false;
+        
+        auto latency = chrono::duration_cast<chrono::microseconds>(now - offerIt->second.offeredAt);
+        offerStats.accepted++;
+        offerStats.totalAcceptLatency += latency;
+        offerStats.maxAcceptLatency = max(offerStats.maxAcceptLatency, latency);
+        
+        shared_ptr<Driver> driver = offerIt->second.offeredDriver;
+        releaseOffer(offerIt);
+        
+        const auto& ride = rides.find(rideId)->second;
+        assignDriver(ride, driver, dispatchConfig.read()->matchingStrategy->getStrategyName());
+        return true;
+    }
+    
+    // Offered driver passes; the ride moves on to the next ranked candidate
+    // without matching again. Returns false if there is no such offer.
+    bool declineOffer(const string& rideId, const string& driverId) {
+        return declineOffer(rideId, driverId, currentTime());
+    }
+    
+    bool declineOffer(const string& rideId, const string& driverId,
+                      chrono::steady_clock::time_point now) {
+        auto offerIt = findOffer(rideId, driverId);
+        if (offerIt == pendingOffers.end()) return false;
+        
+        offerStats.declined++;
+        LOG_EVENT(LogLevel::INFO, LogEvent::OFFER_DECLINED, driverId, rideId, "declined");
+        withdrawOffer(offerIt->second);
+        offerToNextCandidate(rides.find(rideId)->second, offerIt->second, now);
+        return true;
+    }
+    
+    // Driver currently holding the ride's offer, or nullptr
+    shared_ptr<Driver> getOfferedDriver(const string& rideId) const {
+        auto it = pendingOffers.find(rideId);
+        return it != pendingOffers.end() ? it->second.offeredDriver : nullptr;
+    }
+    
+private:
+    void assignDriver(const shared_ptr<Ride>& ride, const shared_ptr<Driver>& driver,
+                      const string& strategyName) {
+        ride->setDriver(driver);
+        ride->setStatus(RideStatus::DRIVER_ASSIGNED);
+        driver->setStatus(DriverStatus::ON_TRIP);
+        driver->setCurrentRideId(ride->getRideId());
+        publishDriverState(driver);
+        
+        armTimeout(ride, timeoutPolicy.assignmentTimeout, CancellationReason::ASSIGNMENT_TIMEOUT);
+        
+        // Notify observers
+        notifyDriverAssigned(ride);
+        notifyRideStatusChanged(ride);
+        
+        LOG_EVENT(LogLevel::INFO, LogEvent::RIDE_CREATED, ride->getRideId(),
+                  driver->getName(), strategyName);
+    }
+    
+    OfferMap::iterator findOffer(const string& rideId, const string& driverId) {
+        auto it = pendingOffers.find(rideId);
+        if (it == pendingOffers.end() || !it->second.offeredDriver ||
+            it->second.offeredDriver->getUserId() != driverId) {
+            return pendingOffers.end();
+        }
+        return it;
+    }
+    
+    // Drops a finished offer, keeping its candidate list's storage for the next one
+    void releaseOffer(OfferMap::iterator it) {
+        vector<shared_ptr<Driver>>& candidates = it->second.candidates;
+        candidates.clear();
+        if (candidates.capacity() > 0) spareCandidateLists.push_back(move(candidates));
+        pendingOffers.erase(it);
+    }
+    
+    // Once the ride map holds more finished rides than the policy keeps, the
+    // oldest is evicted. Called last by completeRide/cancelRide, after every
+    // use of the finishing ride, which itself is never the one evicted.
+    void retainFinishedRide(const string& rideId) {
+        size_t limit = retentionPolicy.finishedRides;
+        if (limit == 0) return;
+        if (finishedRideIds.size() < limit) {
+            finishedRideIds.push_back(rideId);
+            return;
+        }
+        string& oldest = finishedRideIds[finishedHead];
+        rides.erase(oldest);
+        oldest = rideId;
+        finishedHead = (finishedHead + 1) % limit;
+    }
+    
+    // Releases the driver holding the current offer back to the available pool
+    void withdrawOffer(PendingOffer& offer) {
+        if (offer.offeredDriver && offer.offeredDriver->getStatus() == DriverStatus::OFFERED) {
+            offer.offeredDriver->setStatus(DriverStatus::AVAILABLE);
+            publishDriverState(offer.offeredDriver);
+        }
+        offer.offeredDriver = nullptr;
+    }
+    
+    // Offers the ride to the next candidate that is still available, arming the
+    // offer timeout; cancels the ride once the ranked list runs out
+    void offerToNextCandidate(const shared_ptr<Ride>& ride, PendingOffer& offer,
+                              chrono::steady_clock::time_point now) {
+        while (offer.nextCandidate < offer.candidates.size()) {
+            const auto& driver = offer.candidates[offer.nextCandidate++];
+            if (!driver->isAvailable()) {
+                offerStats.skipped++;
+                continue;
+            }
+            
+            driver->setStatus(DriverStatus::OFFERED);
+            publishDriverState(driver);
+            offer.offeredDriver = driver;
+            offer.offeredAt = now;
+            offerStats.offersSent++;
+            armTimeoutAt(ride, now + offerPolicy.offerTimeout, CancellationReason::NONE);
+            
+            LOG_EVENT(LogLevel::INFO, LogEvent::RIDE_OFFERED, ride->getRideId(), driver->getUserId(),
+                      offer.nextCandidate, offer.candidates.size());
+            for (auto& observer : observers) {
+                observer->onRideOffered(ride, driver);
+            }
+            return;
+        }
+        
+        offerStats.exhausted++;
+        cancelRide(ride->getRideId(), CancellationReason::NO_DRIVER_ACCEPTED);
+    }
+    
+    void expireOffer(const shared_ptr<Ride>& ride, PendingOffer& offer,
+                     chrono::steady_clock::time_point now) {
+        offerStats.expired++;
+        LOG_EVENT(LogLevel::INFO, LogEvent::OFFER_DECLINED, offer.offeredDriver->getUserId(),
+                  ride->getRideId(), "offer timed out");
+        withdrawOffer(offer);
+        offerToNextCandidate(ride, offer, now);
+    }
+
+public:
+    
+    // Assigned driver starts heading to the pickup; arms the pickup ETA deadline
+    void driverEnRoute(const string& rideId) {
         auto it = rides.find(rideId);
-        if (it != rides.end()) {
-            auto ride = it->second;
+        if (it != rides.end() && it->second->getStatus() == RideStatus::DRIVER_ASSIGNED) {
+            const auto& ride = it->second;
             ride->setStatus(RideStatus::DRIVER_EN_ROUTE);
             notifyRideStatusChanged(ride);
             
-            // Simulate driver reaching pickup
-            cout << "Driver is en route to pickup location..." << endl;
+            LOG_EVENT(LogLevel::DEBUG, LogEvent::DRIVER_EN_ROUTE,
+                      ride->getDriver() ? ride->getDriver()->getUserId() : string(), rideId);
+            
+            double etaHours = 0.0;
+            if (ride->getDriver()) {
+                etaHours = ride->getDriver()->getCurrentLocation().distanceTo(
+                    ride->getPickupLocation()) / timeoutPolicy.pickupSpeedKmph;
+            }
+            armTimeout(ride,
+                       chrono::duration_cast<chrono::steady_clock::duration>(
+                           chrono::duration<double, ratio<3600>>(etaHours)) +
+                           timeoutPolicy.pickupGrace,
+                       CancellationReason::PICKUP_TIMEOUT);
+        }
+    }
+    
+    // Driver is waiting at the pickup; arms the rider no-show deadline
+    void driverArrived(const string& rideId) {
+        auto it = rides.find(rideId);
+        if (it != rides.end() && it->second->getStatus() == RideStatus::DRIVER_EN_ROUTE) {
+            armTimeout(it->second, timeoutPolicy.noShowTimeout, CancellationReason::RIDER_NO_SHOW);
+        }
+    }
+    
+    // Returns false if the ride is unknown or not waiting for pickup
+    bool startRide(const string& rideId) {
+        auto it = rides.find(rideId);
+        if (it != rides.end()) {
+            const auto& ride = it->second;
+            
+            // Simulate driver reaching pickup if it was never dispatched explicitly
+            if (ride->getStatus() == RideStatus::DRIVER_ASSIGNED) {
+                driverEnRoute(rideId);
+            }
+            if (ride->getStatus() != RideStatus::DRIVER_EN_ROUTE) return false;
+            
+            clearTimeout(ride);
             ride->startRide();
             notifyRideStatusChanged(ride);
+            return true;
         }
+        return false;
     }
     
-    void completeRide(const string& rideId) {
+    // Returns false if the ride is unknown or not in progress; a trip that never
+    // started cannot be completed or billed
+    bool completeRide(const string& rideId) {
         auto it = rides.find(rideId);
-        if (it != rides.end()) {
-            auto ride = it->second;
+        if (it != rides.end() && it->second->getStatus() == RideStatus::IN_PROGRESS) {
+            const auto& ride = it->second;
+            clearTimeout(ride);
             ride->completeRide();
             
             // Calculate fare
-            double fare = fareCalculator->calculateFare(*ride);
+            auto config = dispatchConfig.read();
+            double fare = config->fareCalculator->calculateFare(*ride);
             ride->setFare(fare);
+            ride->setSurgeMultiplier(config->fareCalculator->getSurgeMultiplier());
             
             // Update driver status
             if (ride->getDriver()) {
                 ride->getDriver()->setStatus(DriverStatus::AVAILABLE);
-                ride->getDriver()->addRideToHistory(rideId);
+                ride->getDriver()->clearCurrentRideId();
+                ride->getDriver()->addRideToHistory(rideId, retentionPolicy.historyPerUser);
+                publishDriverState(ride->getDriver());
             }
             
             // Update rider history
-            ride->getRider()->addRideToHistory(rideId);
+            ride->getRider()->addRideToHistory(rideId, retentionPolicy.historyPerUser);
             
             notifyRideStatusChanged(ride);
             notifyPaymentCompleted(ride);
             
-            cout << "Ride " << rideId << " completed. Fare: $" << fare 
-                 << " (calculated using " << fareCalculator->getDescription() << ")" << endl;
+            LOG_EVENT(LogLevel::INFO, LogEvent::RIDE_COMPLETED, rideId, fare,
+                      config->fareCalculator->getDescription());
+            retainFinishedRide(ride->getRideId());
+            return true;
         }
+        return false;
+    }
+    
+    // Position report from a driver's device. Moves the driver and, while
+    // their ride is in progress, appends the fix to the ride's GPS trace.
+    // Returns false for unknown drivers and for non-finite or out-of-range
+    // coordinates, which are dropped before anything is recorded.
+    bool updateDriverLocation(const string& driverId, const Location& location,
+                              chrono::system_clock::time_point time = chrono::system_clock::now()) {
+        if (!location.hasValidCoordinates()) return false;
+        auto driverIt = driversById.find(driverId);
+        if (driverIt == driversById.end()) return false;
+        
+        const auto& driver = driverIt->second;
+        driver->setCurrentLocation(location);
+        publishDriverState(driver);
+        
+        if (!driver->getCurrentRideId().empty()) {
+            auto rideIt = rides.find(driver->getCurrentRideId());
+            if (rideIt != rides.end()) {
+                rideIt->second->recordLocation(location, time);
+            }
+        }
+        return true;
+    }
+    
+    // Fare estimate with the current pricing chain, before any driver is
+    // assigned. Trips the geofence would reject are not quoted: returns false
+    // and leaves the reason in 'service'.
+    bool quoteFare(const Location& pickup, const Location& dropoff, VehicleType vehicleType,
+                   double& fare, ServiceCheck& service) {
+        service = geofence ? geofence->checkRequest(pickup, dropoff, vehicleType) : ServiceCheck();
+        if (!service.isAllowed()) return false;
+        
+        static const string quoteId = "QUOTE";
+        Ride quote(quoteId, nullptr, pickup, dropoff, vehicleType);
+        fare = dispatchConfig.read()->fareCalculator->calculateFare(quote);
+        return true;
+    }
+    
+    // Cancels an active ride and releases its driver; returns false if the
+    // ride is unknown or already finished
+    bool cancelRide(const string& rideId,
+                    CancellationReason reason = CancellationReason::RIDER_CANCELLED) {
+        auto it = rides.find(rideId);
+        if (it == rides.end() || !it->second->isActive()) return false;
+        
+        const auto& ride = it->second;
+        clearTimeout(ride);
+        ride->cancel(reason);
+        
+        auto offerIt = pendingOffers.find(rideId);
+        if (offerIt != pendingOffers.end()) {
+            withdrawOffer(offerIt->second);
+            releaseOffer(offerIt);
+        }
+        
+        if (ride->getDriver()) {
+            ride->getDriver()->setStatus(DriverStatus::AVAILABLE);
+            ride->getDriver()->clearCurrentRideId();
+            publishDriverState(ride->getDriver());
+        }
+        
+        notifyRideStatusChanged(ride);
+        LOG_EVENT(LogLevel::INFO, LogEvent::RIDE_CANCELLED, rideId,
+                  ride->getCancellationReasonString());
+        retainFinishedRide(ride->getRideId());
+        return true;
+    }
+    
+    // Clock every deadline is armed on: steady time, but never behind the
+    // furthest 'now' passed to processTimeouts. The timing wheel only moves
+    // forward, so once a caller has expired timeouts ahead of real time (e.g. a
+    // simulation skipping minutes), new deadlines are measured from that point
+    // instead of being clamped to the next tick and firing early.
+    chrono::steady_clock::time_point currentTime() const {
+        return max(chrono::steady_clock::now(), latestProcessedTime);
+    }
+    
+    // Expires lifecycle deadlines up to 'now'; returns the number of rides
+    // cancelled. A 'now' behind currentTime() expires nothing new.
+    size_t processTimeouts(chrono::steady_clock::time_point now = chrono::steady_clock::now()) {
+        if (now > latestProcessedTime) latestProcessedTime = now;
+        size_t cancelled = 0;
+        timeoutWheel.advance(now, [this, &cancelled, now](const RideTimeout& timeout) {
+            auto it = rides.find(timeout.rideId);
+            if (it == rides.end()) return;
+            
+            it->second->setTimeoutTimer(INVALID_TIMER_ID);
+            
+            // An unanswered offer passes to the next candidate instead of cancelling
+            auto offerIt = pendingOffers.find(timeout.rideId);
+            if (offerIt != pendingOffers.end()) {
+                expireOffer(it->second, offerIt->second, now);
+                if (!it->second->isActive()) cancelled++;
+                return;
+            }
+            if (cancelRide(timeout.rideId, timeout.reason)) cancelled++;
+        });
+        return cancelled;
     }
     
     // Notification methods
-    void notifyRideStatusChanged(shared_ptr<Ride> ride) {
+    void notifyRideStatusChanged(const shared_ptr<Ride>& ride) {
         for (auto& observer : observers) {
             observer->onRideStatusChanged(ride);
         }
     }
     
-    void notifyDriverAssigned(shared_ptr<Ride> ride) {
+    void notifyDriverAssigned(const shared_ptr<Ride>& ride) {
         for (auto& observer : observers) {
             observer->onDriverAssigned(ride);
         }
     }
     
-    void notifyPaymentCompleted(shared_ptr<Ride> ride) {
+    void notifyPaymentCompleted(const shared_ptr<Ride>& ride) {
         for (auto& observer : observers) {
             observer->onPaymentCompleted(ride);
         }
@@ -185,6 +798,8 @@ public:
         return (it != rides.end()) ? it->second : nullptr;
     }
     
+    const RideMap& getRides() const { return rides; }
+    
     void printSystemStatus() {
         cout << "\n=== SYSTEM STATUS ===" << endl;
         cout << "Total Riders: " << riders.size() << endl;
@@ -196,8 +811,10 @@ public:
             if (driver->isAvailable()) availableDrivers++;
         }
         cout << "Available Drivers: " << availableDrivers << endl;
-        cout << "Current Matching Strategy: " << matchingStrategy->getStrategyName() << endl;
-        cout << "Current Fare Calculator: " << fareCalculator->getDescription() << endl;
+        auto config = dispatchConfig.read();
+        cout << "Current Matching Strategy: " << config->matchingStrategy->getStrategyName() << endl;
+        cout << "Current Fare Calculator: " << config->fareCalculator->getDescription() << endl;
+        cout << "Dispatch Config Version: " << config->version << endl;
         cout << "===================" << endl;
     }
 };
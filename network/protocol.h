@@ -0,0 +1,175 @@
+#ifndef PROTOCOL_H
+#define PROTOCOL_H
+
+#include "../common/types.h"
+#include "../geofence/geofence_index.h"
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// Wire format shared by the ride server, client and load tool.
+//
+// Every message is one frame:
+//   [u32 length][u8 type][u32 requestId][body...]
+// 'length' counts everything after itself. Integers and doubles are
+// little-endian; strings are a u8 length followed by the bytes. Responses
+// echo the requestId and set RESPONSE_FLAG on the type, and a connection's
+// responses always come back in request order, so clients may pipeline.
+//
+// Bodies:
+//   REQUEST_RIDE  riderId, pickupLat, pickupLng, dropoffLat, dropoffLng, u8 vehicleType
+//              -> u8 status, rideId, driverId          (OK)
+//              -> u8 status, u8 ServiceDecision        (REJECTED)
+//              -> u8 status                            (NOT_FOUND rider, NO_DRIVER)
+//   START_RIDE    rideId -> u8 status
+//   COMPLETE_RIDE rideId -> u8 status, f64 fare
+//   QUOTE         pickupLat, pickupLng, dropoffLat, dropoffLng, u8 vehicleType
+//              -> u8 status, f64 fare, f64 distanceKm  (OK)
+//              -> u8 status, u8 ServiceDecision        (REJECTED)
+//   DRIVER_LOCATION driverId, lat, lng -> u8 status
+//
+// Coordinates must be finite with |lat| <= 90 and |lng| <= 180; a frame
+// carrying any other value is answered BAD_REQUEST.
+
+enum class MessageType : uint8_t {
+    REQUEST_RIDE = 1,
+    START_RIDE = 2,
+    COMPLETE_RIDE = 3,
+    QUOTE = 4,
+    DRIVER_LOCATION = 5
+};
+
+enum class ResponseStatus : uint8_t {
+    OK,
+    NOT_FOUND,
+    NO_DRIVER,
+    INVALID_STATE,
+    BAD_REQUEST,
+    REJECTED        // trip cannot be served here (geofence); retrying will not help
+};
+
+const size_t RESPONSE_STATUS_COUNT = 6;
+
+const uint8_t RESPONSE_FLAG = 0x80;
+const size_t FRAME_LENGTH_SIZE = 4;
+const size_t MESSAGE_HEADER_SIZE = 5;   // type + requestId
+const size_t MAX_FRAME_LENGTH = 4096;
+
+// Appends one frame to a byte buffer; the length prefix is patched in finish()
+class FrameWriter {
+private:
+    vector<uint8_t>& out;
+    size_t frameStart;
+
+public:
+    FrameWriter(vector<uint8_t>& buffer, uint8_t type, uint32_t requestId)
+        : out(buffer), frameStart(buffer.size()) {
+        putU32(0);
+        putU8(type);
+        putU32(requestId);
+    }
+
+    void putU8(uint8_t value) { out.push_back(value); }
+
+    void putU32(uint32_t value) {
+        for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void putU64(uint64_t value) {
+        for (int i = 0; i < 8; i++) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    void putF64(double value) {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        putU64(bits);
+    }
+
+    void putString(const string& value) {
+        size_t length = min<size_t>(value.size(), 255);
+        putU8(static_cast<uint8_t>(length));
+        out.insert(out.end(), value.begin(), value.begin() + length);
+    }
+
+    void finish() {
+        uint32_t length = static_cast<uint32_t>(out.size() - frameStart - FRAME_LENGTH_SIZE);
+        for (int i = 0; i < 4; i++) out[frameStart + i] = static_cast<uint8_t>(length >> (8 * i));
+    }
+};
+
+// Reads fields from one frame body; any overrun flips isValid() to false,
+// as does a field the caller rejects through invalidate()
+class FrameReader {
+private:
+    const uint8_t* data;
+    size_t remaining;
+    bool valid;
+
+    bool need(size_t bytes) {
+        if (remaining < bytes) valid = false;
+        return valid;
+    }
+
+public:
+    FrameReader(const uint8_t* body, size_t length) : data(body), remaining(length), valid(true) {}
+
+    bool isValid() const { return valid; }
+
+    // For fields that decode but fail a semantic check (e.g. a NaN coordinate)
+    void invalidate() { valid = false; }
+
+    uint8_t getU8() {
+        if (!need(1)) return 0;
+        remaining--;
+        return *data++;
+    }
+
+    uint32_t getU32() {
+        if (!need(4)) return 0;
+        uint32_t value = 0;
+        for (int i = 0; i < 4; i++) value |= static_cast<uint32_t>(data[i]) << (8 * i);
+        data += 4;
+        remaining -= 4;
+        return value;
+    }
+
+    uint64_t getU64() {
+        if (!need(8)) return 0;
+        uint64_t value = 0;
+        for (int i = 0; i < 8; i++) value |= static_cast<uint64_t>(data[i]) << (8 * i);
+        data += 8;
+        remaining -= 8;
+        return value;
+    }
+
+    double getF64() {
+        uint64_t bits = getU64();
+        double value;
+        memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    string getString() {
+        size_t length = getU8();
+        if (!need(length)) return string();
+        string value(reinterpret_cast<const char*>(data), length);
+        data += length;
+        remaining -= length;
+        return value;
+    }
+};
+
+// Returns the total size of the complete frame at 'data', 0 if more bytes
+// are needed, or SIZE_MAX if the frame is malformed
+inline size_t completeFrameSize(const uint8_t* data, size_t available) {
+    if (available < FRAME_LENGTH_SIZE) return 0;
+
+    uint32_t length = 0;
+    for (int i = 0; i < 4; i++) length |= static_cast<uint32_t>(data[i]) << (8 * i);
+    if (length < MESSAGE_HEADER_SIZE || length > MAX_FRAME_LENGTH) return SIZE_MAX;
+
+    size_t total = FRAME_LENGTH_SIZE + length;
+    return available >= total ? total : 0;
+}
+
+#endif
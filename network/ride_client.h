@@ -0,0 +1,270 @@
+#ifndef RIDE_CLIENT_H
+#define RIDE_CLIENT_H
+
+#include "protocol.h"
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define RIDE_CLIENT_SUPPORTED 1
+#else
+#define RIDE_CLIENT_SUPPORTED 0
+#endif
+
+// Builds request frames; shared by RideClient and the load tool
+class RideRequestEncoder {
+private:
+    static void putLocation(FrameWriter& frame, const Location& location) {
+        frame.putF64(location.latitude);
+        frame.putF64(location.longitude);
+    }
+
+public:
+    static void requestRide(vector<uint8_t>& out, uint32_t requestId, const string& riderId,
+                            const Location& pickup, const Location& dropoff, VehicleType type) {
+        FrameWriter frame(out, static_cast<uint8_t>(MessageType::REQUEST_RIDE), requestId);
+        frame.putString(riderId);
+        putLocation(frame, pickup);
+        putLocation(frame, dropoff);
+        frame.putU8(static_cast<uint8_t>(type));
+        frame.finish();
+    }
+
+    static void startRide(vector<uint8_t>& out, uint32_t requestId, const string& rideId) {
+        FrameWriter frame(out, static_cast<uint8_t>(MessageType::START_RIDE), requestId);
+        frame.putString(rideId);
+        frame.finish();
+    }
+
+    static void completeRide(vector<uint8_t>& out, uint32_t requestId, const string& rideId) {
+        FrameWriter frame(out, static_cast<uint8_t>(MessageType::COMPLETE_RIDE), requestId);
+        frame.putString(rideId);
+        frame.finish();
+    }
+
+    static void quote(vector<uint8_t>& out, uint32_t requestId,
+                      const Location& pickup, const Location& dropoff, VehicleType type) {
+        FrameWriter frame(out, static_cast<uint8_t>(MessageType::QUOTE), requestId);
+        putLocation(frame, pickup);
+        putLocation(frame, dropoff);
+        frame.putU8(static_cast<uint8_t>(type));
+        frame.finish();
+    }
+
+    static void driverLocation(vector<uint8_t>& out, uint32_t requestId, const string& driverId,
+                               const Location& location) {
+        FrameWriter frame(out, static_cast<uint8_t>(MessageType::DRIVER_LOCATION), requestId);
+        frame.putString(driverId);
+        putLocation(frame, location);
+        frame.finish();
+    }
+};
+
+// Decoded response; fields not carried by the message type stay empty
+struct RideResponse {
+    MessageType type;
+    uint32_t requestId;
+    ResponseStatus status;
+    string rideId;
+    string driverId;
+    double fare;
+    double distanceKm;
+    ServiceDecision rejection;      // set with REJECTED
+
+    RideResponse()
+        : type(MessageType::QUOTE), requestId(0), status(ResponseStatus::BAD_REQUEST),
+          fare(0.0), distanceKm(0.0), rejection(ServiceDecision::ALLOWED) {}
+
+    bool isOk() const { return status == ResponseStatus::OK; }
+
+    // 'frame' is one complete frame as sized by completeFrameSize
+    bool decode(const uint8_t* frame, size_t size) {
+        if (size < FRAME_LENGTH_SIZE + MESSAGE_HEADER_SIZE) return false;
+        FrameReader reader(frame + FRAME_LENGTH_SIZE, size - FRAME_LENGTH_SIZE);
+
+        uint8_t rawType = reader.getU8();
+        if (!(rawType & RESPONSE_FLAG)) return false;
+        type = static_cast<MessageType>(rawType & ~RESPONSE_FLAG);
+        requestId = reader.getU32();
+        status = static_cast<ResponseStatus>(reader.getU8());
+        rideId.clear();
+        driverId.clear();
+        fare = 0.0;
+        distanceKm = 0.0;
+        rejection = ServiceDecision::ALLOWED;
+
+        if (status == ResponseStatus::REJECTED) {
+            rejection = static_cast<ServiceDecision>(reader.getU8());
+        } else if (type == MessageType::REQUEST_RIDE && status == ResponseStatus::OK) {
+            rideId = reader.getString();
+            driverId = reader.getString();
+        } else if (type == MessageType::COMPLETE_RIDE) {
+            fare = reader.getF64();
+        } else if (type == MessageType::QUOTE && status == ResponseStatus::OK) {
+            fare = reader.getF64();
+            distanceKm = reader.getF64();
+        }
+        return reader.isValid();
+    }
+};
+
+inline const char* responseStatusString(ResponseStatus status) {
+    switch (status) {
+        case ResponseStatus::OK: return "OK";
+        case ResponseStatus::NOT_FOUND: return "NOT_FOUND";
+        case ResponseStatus::NO_DRIVER: return "NO_DRIVER";
+        case ResponseStatus::INVALID_STATE: return "INVALID_STATE";
+        case ResponseStatus::BAD_REQUEST: return "BAD_REQUEST";
+        case ResponseStatus::REJECTED: return "REJECTED";
+        default: return "UNKNOWN";
+    }
+}
+
+#if RIDE_CLIENT_SUPPORTED
+
+// Blocking client for one server connection. Requests may be pipelined:
+// send several, then receive() returns their responses in the same order.
+class RideClient {
+private:
+    int fd;
+    uint32_t nextRequestId;
+    vector<uint8_t> outgoing;
+    vector<uint8_t> incoming;
+
+    bool writeAll(const vector<uint8_t>& data) {
+        size_t sent = 0;
+        while (sent < data.size()) {
+            ssize_t n = ::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            sent += static_cast<size_t>(n);
+        }
+        return true;
+    }
+
+    bool flush() {
+        bool ok = writeAll(outgoing);
+        outgoing.clear();
+        return ok;
+    }
+
+public:
+    RideClient() : fd(-1), nextRequestId(1) {}
+
+    ~RideClient() { disconnect(); }
+
+    RideClient(const RideClient&) = delete;
+    RideClient& operator=(const RideClient&) = delete;
+
+    bool connect(const string& address, uint16_t port) {
+        disconnect();
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) return false;
+
+        fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            disconnect();
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        return true;
+    }
+
+    void disconnect() {
+        if (fd >= 0) close(fd);
+        fd = -1;
+        incoming.clear();
+    }
+
+    bool isConnected() const { return fd >= 0; }
+
+    // Each send* call writes one request and returns its request id, or 0 on failure
+    uint32_t sendRequestRide(const string& riderId, const Location& pickup,
+                             const Location& dropoff, VehicleType type) {
+        uint32_t id = nextRequestId++;
+        RideRequestEncoder::requestRide(outgoing, id, riderId, pickup, dropoff, type);
+        return flush() ? id : 0;
+    }
+
+    uint32_t sendStartRide(const string& rideId) {
+        uint32_t id = nextRequestId++;
+        RideRequestEncoder::startRide(outgoing, id, rideId);
+        return flush() ? id : 0;
+    }
+
+    uint32_t sendCompleteRide(const string& rideId) {
+        uint32_t id = nextRequestId++;
+        RideRequestEncoder::completeRide(outgoing, id, rideId);
+        return flush() ? id : 0;
+    }
+
+    uint32_t sendQuote(const Location& pickup, const Location& dropoff, VehicleType type) {
+        uint32_t id = nextRequestId++;
+        RideRequestEncoder::quote(outgoing, id, pickup, dropoff, type);
+        return flush() ? id : 0;
+    }
+
+    uint32_t sendDriverLocation(const string& driverId, const Location& location) {
+        uint32_t id = nextRequestId++;
+        RideRequestEncoder::driverLocation(outgoing, id, driverId, location);
+        return flush() ? id : 0;
+    }
+
+    // Blocks for the next response; false if the connection closed or the
+    // server sent something undecodable
+    bool receive(RideResponse& response) {
+        uint8_t chunk[4096];
+        for (;;) {
+            size_t frameSize = completeFrameSize(incoming.data(), incoming.size());
+            if (frameSize == SIZE_MAX) return false;
+            if (frameSize > 0) {
+                bool ok = response.decode(incoming.data(), frameSize);
+                incoming.erase(incoming.begin(), incoming.begin() + frameSize);
+                return ok;
+            }
+
+            ssize_t n = ::recv(fd, chunk, sizeof(chunk), 0);
+            if (n < 0 && errno == EINTR) continue;
+            if (n <= 0) return false;
+            incoming.insert(incoming.end(), chunk, chunk + n);
+        }
+    }
+
+    // One request, one response
+    bool requestRide(const string& riderId, const Location& pickup, const Location& dropoff,
+                     VehicleType type, RideResponse& response) {
+        return sendRequestRide(riderId, pickup, dropoff, type) && receive(response);
+    }
+
+    bool startRide(const string& rideId, RideResponse& response) {
+        return sendStartRide(rideId) && receive(response);
+    }
+
+    bool completeRide(const string& rideId, RideResponse& response) {
+        return sendCompleteRide(rideId) && receive(response);
+    }
+
+    bool quote(const Location& pickup, const Location& dropoff, VehicleType type,
+               RideResponse& response) {
+        return sendQuote(pickup, dropoff, type) && receive(response);
+    }
+
+    bool driverLocation(const string& driverId, const Location& location, RideResponse& response) {
+        return sendDriverLocation(driverId, location) && receive(response);
+    }
+};
+
+#endif
+
+#endif
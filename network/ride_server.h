@@ -0,0 +1,453 @@
+#ifndef RIDE_SERVER_H
+#define RIDE_SERVER_H
+
+#include "protocol.h"
+#include "../managers/ride_manager.h"
+#include <atomic>
+#include <cerrno>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define RIDE_SERVER_SUPPORTED 1
+#else
+#define RIDE_SERVER_SUPPORTED 0
+#endif
+
+struct RideServerStats {
+    uint64_t acceptedConnections;
+    uint64_t closedConnections;
+    uint64_t protocolErrors;
+    uint64_t requests;
+    uint64_t batches;
+    uint64_t largestBatch;
+
+    RideServerStats()
+        : acceptedConnections(0), closedConnections(0), protocolErrors(0),
+          requests(0), batches(0), largestBatch(0) {}
+};
+
+#if RIDE_SERVER_SUPPORTED
+
+// Single-threaded TCP front end for RideManager. One non-blocking epoll loop
+// owns every connection; each wakeup first reads and frames everything the
+// ready sockets have, then runs the whole batch against RideManager in
+// arrival order, then writes the responses back. RideManager is therefore
+// only ever touched from the loop thread.
+class RideServer {
+private:
+    struct Connection {
+        int fd;
+        vector<uint8_t> input;
+        size_t inputStart;          // first byte not yet framed
+        vector<uint8_t> output;
+        size_t outputStart;         // first byte not yet written
+        uint32_t registeredEvents;  // epoll interest currently set for fd
+        bool readClosed;            // peer sent EOF or a bad frame; finish writing, then close
+        bool readPaused;            // too much unsent output; resume once it drains
+        bool failed;                // hard socket error; close without flushing
+        bool touched;               // already on this iteration's touched list
+
+        explicit Connection(int f)
+            : fd(f), inputStart(0), outputStart(0), registeredEvents(EPOLLIN | EPOLLRDHUP),
+              readClosed(false), readPaused(false), failed(false), touched(false) {}
+
+        size_t pendingOutput() const { return output.size() - outputStart; }
+        bool hasPendingOutput() const { return outputStart < output.size(); }
+        bool isReading() const { return !readClosed && !readPaused; }
+    };
+
+    // Points into the owning connection's input buffer, which is only
+    // compacted after the batch has run
+    struct PendingRequest {
+        Connection* connection;
+        MessageType type;
+        uint32_t requestId;
+        const uint8_t* body;
+        size_t bodyLength;
+    };
+
+    static const size_t READ_CHUNK = 16384;
+    static const size_t MAX_READ_PER_WAKEUP = 65536;   // level-triggered, so the rest waits a turn
+    static const int MAX_EVENTS = 1024;
+    // Backpressure: a connection whose peer is not reading its responses stops
+    // being read above the high-water mark, so its output is bounded by the mark
+    // plus one wakeup's worth of responses; reading resumes below the low mark
+    static const size_t OUTPUT_HIGH_WATER = 262144;
+    static const size_t OUTPUT_LOW_WATER = 65536;
+
+    RideManager& manager;
+    int listenFd;
+    int epollFd;
+    atomic<bool> running;
+    vector<Connection*> connections;        // indexed by fd
+    vector<Connection*> touched;            // connections with I/O this iteration
+    vector<PendingRequest> batch;
+    vector<epoll_event> events;
+    RideServerStats stats;
+
+    void touch(Connection* connection) {
+        if (!connection->touched) {
+            connection->touched = true;
+            touched.push_back(connection);
+        }
+    }
+
+    // Reads while the peer may still send and output is below the high-water
+    // mark; EPOLLOUT only while output is pending
+    void updateInterest(Connection* connection) {
+        if (connection->pendingOutput() >= OUTPUT_HIGH_WATER) {
+            connection->readPaused = true;
+        } else if (connection->pendingOutput() <= OUTPUT_LOW_WATER) {
+            connection->readPaused = false;
+        }
+
+        uint32_t wanted = 0;
+        if (connection->isReading()) wanted |= EPOLLIN | EPOLLRDHUP;
+        if (connection->hasPendingOutput()) wanted |= EPOLLOUT;
+        if (connection->registeredEvents == wanted) return;
+
+        epoll_event ev;
+        ev.events = wanted;
+        ev.data.fd = connection->fd;
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection->fd, &ev);
+        connection->registeredEvents = wanted;
+    }
+
+    void closeConnection(Connection* connection) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, connection->fd, nullptr);
+        close(connection->fd);
+        connections[connection->fd] = nullptr;
+        delete connection;
+        stats.closedConnections++;
+    }
+
+    void acceptAll() {
+        for (;;) {
+            int fd = accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0) return;     // EAGAIN, or out of descriptors until some close
+
+            int one = 1;
+            setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+
+            epoll_event ev;
+            ev.events = EPOLLIN | EPOLLRDHUP;
+            ev.data.fd = fd;
+            if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev) != 0) {
+                close(fd);
+                continue;
+            }
+            if (static_cast<size_t>(fd) >= connections.size()) {
+                connections.resize(fd + 1, nullptr);
+            }
+            connections[fd] = new Connection(fd);
+            stats.acceptedConnections++;
+        }
+    }
+
+    // Drains the socket, then queues every complete frame for this batch
+    void readAndFrame(Connection* connection) {
+        vector<uint8_t>& in = connection->input;
+        size_t received = 0;
+        while (received < MAX_READ_PER_WAKEUP) {
+            size_t used = in.size();
+            in.resize(used + READ_CHUNK);
+            ssize_t n = recv(connection->fd, in.data() + used, READ_CHUNK, 0);
+            in.resize(used + (n > 0 ? static_cast<size_t>(n) : 0));
+            if (n > 0) {
+                received += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else if (n == 0) {
+                // Half-close: stop reading but keep writing until every owed response is out
+                connection->readClosed = true;
+                break;
+            } else {
+                if (errno != EAGAIN && errno != EWOULDBLOCK) connection->failed = true;
+                break;
+            }
+        }
+
+        size_t offset = connection->inputStart;
+        for (;;) {
+            size_t frameSize = completeFrameSize(in.data() + offset, in.size() - offset);
+            if (frameSize == 0) break;
+            if (frameSize == SIZE_MAX) {
+                // Answer what was framed before the bad frame, then close
+                stats.protocolErrors++;
+                connection->readClosed = true;
+                break;
+            }
+
+            const uint8_t* frame = in.data() + offset;
+            PendingRequest request;
+            request.connection = connection;
+            request.type = static_cast<MessageType>(frame[FRAME_LENGTH_SIZE]);
+            request.requestId = 0;
+            for (int i = 0; i < 4; i++) {
+                request.requestId |= static_cast<uint32_t>(frame[FRAME_LENGTH_SIZE + 1 + i]) << (8 * i);
+            }
+            request.body = frame + FRAME_LENGTH_SIZE + MESSAGE_HEADER_SIZE;
+            request.bodyLength = frameSize - FRAME_LENGTH_SIZE - MESSAGE_HEADER_SIZE;
+            batch.push_back(request);
+            offset += frameSize;
+        }
+        connection->inputStart = offset;
+        touch(connection);
+    }
+
+    void flushOutput(Connection* connection) {
+        vector<uint8_t>& out = connection->output;
+        while (connection->outputStart < out.size()) {
+            ssize_t n = send(connection->fd, out.data() + connection->outputStart,
+                             out.size() - connection->outputStart, MSG_NOSIGNAL);
+            if (n > 0) {
+                connection->outputStart += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) connection->failed = true;
+                break;
+            }
+        }
+
+        if (!connection->hasPendingOutput()) {
+            out.clear();
+            connection->outputStart = 0;
+        }
+    }
+
+    // Non-finite or out-of-range coordinates invalidate the frame, so the
+    // request is answered BAD_REQUEST instead of reaching the manager
+    static Location readLocation(FrameReader& reader) {
+        double lat = reader.getF64();
+        double lng = reader.getF64();
+        Location location(lat, lng);
+        if (!location.hasValidCoordinates()) reader.invalidate();
+        return location;
+    }
+
+    static bool readVehicleType(FrameReader& reader, VehicleType& type) {
+        uint8_t raw = reader.getU8();
+        if (raw >= VEHICLE_TYPE_COUNT) return false;
+        type = static_cast<VehicleType>(raw);
+        return true;
+    }
+
+    void execute(const PendingRequest& request) {
+        vector<uint8_t>& out = request.connection->output;
+        FrameWriter response(out, static_cast<uint8_t>(request.type) | RESPONSE_FLAG,
+                             request.requestId);
+        FrameReader reader(request.body, request.bodyLength);
+
+        switch (request.type) {
+            case MessageType::REQUEST_RIDE: {
+                string riderId = reader.getString();
+                Location pickup = readLocation(reader);
+                Location dropoff = readLocation(reader);
+                VehicleType type = VehicleType::SEDAN;
+                if (!readVehicleType(reader, type) || !reader.isValid()) {
+                    response.putU8(static_cast<uint8_t>(ResponseStatus::BAD_REQUEST));
+                    break;
+                }
+                RideRequestOutcome outcome;
+                auto ride = manager.requestRide(riderId, pickup, dropoff, type, RideType::NORMAL,
+                                                &outcome);
+                if (ride) {
+                    response.putU8(static_cast<uint8_t>(ResponseStatus::OK));
+                    response.putString(ride->getRideId());
+                    // With offers enabled the ride is still waiting on its first candidate
+                    auto driver = ride->getDriver() ? ride->getDriver()
+                                                    : manager.getOfferedDriver(ride->getRideId());
+                    response.putString(driver ? driver->getUserId() : string());
+                } else if (outcome.failure == RequestFailure::NOT_SERVICEABLE) {
+                    response.putU8(static_cast<uint8_t>(ResponseStatus::REJECTED));
+                    response.putU8(static_cast<uint8_t>(outcome.service.decision));
+                } else {
+                    response.putU8(static_cast<uint8_t>(
+                        outcome.failure == RequestFailure::RIDER_NOT_FOUND ? ResponseStatus::NOT_FOUND
+                                                                           : ResponseStatus::NO_DRIVER));
+                }
+                break;
+            }
+            case MessageType::START_RIDE:
+            case MessageType::COMPLETE_RIDE: {
+                string rideId = reader.getString();
+                if (!reader.isValid()) {
+                    response.putU8(static_cast<uint8_t>(ResponseStatus::BAD_REQUEST));
+                    break;
+                }
+                auto ride = manager.getRide(rideId);
+                bool done = ride && (request.type == MessageType::START_RIDE
+                                     ? manager.startRide(rideId)
+                                     : manager.completeRide(rideId));
+                ResponseStatus status = !ride ? ResponseStatus::NOT_FOUND
+                                      : done ? ResponseStatus::OK
+                                      : ResponseStatus::INVALID_STATE;
+                response.putU8(static_cast<uint8_t>(status));
+                if (request.type == MessageType::COMPLETE_RIDE) {
+                    response.putF64(done ? ride->getFare() : 0.0);
+                }
+                break;
+            }
+            case MessageType::QUOTE: {
+                Location pickup = readLocation(reader);
+                Location dropoff = readLocation(reader);
+                VehicleType type = VehicleType::SEDAN;
+                if (!readVehicleType(reader, type) || !reader.isValid()) {
+                    response.putU8(static_cast<uint8_t>(ResponseStatus::BAD_REQUEST));
+                    break;
+                }
+                double fare = 0.0;
+                ServiceCheck service;
+                if (!manager.quoteFare(pickup, dropoff, type, fare, service)) {
+                    response.putU8(static_cast<uint8_t>(ResponseStatus::REJECTED));
+                    response.putU8(static_cast<uint8_t>(service.decision));
+                    break;
+                }
+                response.putU8(static_cast<uint8_t>(ResponseStatus::OK));
+                response.putF64(fare);
+                response.putF64(pickup.distanceTo(dropoff));
+                break;
+            }
+            case MessageType::DRIVER_LOCATION: {
+                string driverId = reader.getString();
+                Location location = readLocation(reader);
+                if (!reader.isValid()) {
+                    response.putU8(static_cast<uint8_t>(ResponseStatus::BAD_REQUEST));
+                    break;
+                }
+                bool known = manager.updateDriverLocation(driverId, location);
+                response.putU8(static_cast<uint8_t>(known ? ResponseStatus::OK
+                                                          : ResponseStatus::NOT_FOUND));
+                break;
+            }
+            default:
+                response.putU8(static_cast<uint8_t>(ResponseStatus::BAD_REQUEST));
+                break;
+        }
+        response.finish();
+    }
+
+public:
+    explicit RideServer(RideManager& rideManager)
+        : manager(rideManager), listenFd(-1), epollFd(-1), running(false), events(MAX_EVENTS) {}
+
+    RideServer(const RideServer&) = delete;
+    RideServer& operator=(const RideServer&) = delete;
+
+    ~RideServer() {
+        for (Connection* connection : connections) {
+            if (connection) closeConnection(connection);
+        }
+        if (listenFd >= 0) close(listenFd);
+        if (epollFd >= 0) close(epollFd);
+    }
+
+    // Binds and listens; returns false (with errno set) on failure
+    bool listen(const string& address, uint16_t port, int backlog = 4096) {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+            errno = EINVAL;
+            return false;
+        }
+
+        listenFd = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (listenFd < 0) return false;
+
+        int one = 1;
+        setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        if (bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+            ::listen(listenFd, backlog) != 0) {
+            return false;
+        }
+
+        epollFd = epoll_create1(EPOLL_CLOEXEC);
+        if (epollFd < 0) return false;
+
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.fd = listenFd;
+        return epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &ev) == 0;
+    }
+
+    // Runs the event loop until stop(); ride timeouts and retired dispatch
+    // configs are processed on every wakeup, so the loop never sleeps longer
+    // than pollIntervalMs
+    void run(int pollIntervalMs = 50) {
+        running.store(true);
+        while (running.load(memory_order_relaxed)) {
+            int ready = epoll_wait(epollFd, events.data(), MAX_EVENTS, pollIntervalMs);
+            if (ready < 0 && errno != EINTR) break;
+
+            for (int i = 0; i < ready; i++) {
+                int fd = events[i].data.fd;
+                if (fd == listenFd) {
+                    acceptAll();
+                    continue;
+                }
+
+                Connection* connection = connections[fd];
+                if (!connection) continue;
+                if (connection->isReading() &&
+                    (events[i].events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP | EPOLLERR))) {
+                    readAndFrame(connection);
+                }
+                // Writable, or hung up while still owing output: the flush below
+                // either makes progress or hits the error and closes
+                touch(connection);
+            }
+
+            if (!batch.empty()) {
+                stats.batches++;
+                stats.requests += batch.size();
+                stats.largestBatch = max<uint64_t>(stats.largestBatch, batch.size());
+                for (const PendingRequest& request : batch) {
+                    execute(request);
+                }
+                batch.clear();
+            }
+
+            for (Connection* connection : touched) {
+                connection->touched = false;
+                vector<uint8_t>& in = connection->input;
+                in.erase(in.begin(), in.begin() + connection->inputStart);
+                connection->inputStart = 0;
+
+                flushOutput(connection);
+                if (connection->failed ||
+                    (connection->readClosed && !connection->hasPendingOutput())) {
+                    closeConnection(connection);
+                } else {
+                    updateInterest(connection);
+                }
+            }
+            touched.clear();
+
+            manager.processTimeouts();
+            manager.reclaimRetiredConfigs();
+        }
+    }
+
+    // Safe to call from a signal handler or another thread
+    void stop() { running.store(false); }
+
+    const RideServerStats& getStats() const { return stats; }
+
+    size_t getOpenConnectionCount() const {
+        return stats.acceptedConnections - stats.closedConnections;
+    }
+};
+
+#endif
+
+#endif
@@ -6,24 +6,27 @@
 class NotificationObserver {
 public:
     virtual ~NotificationObserver() = default;
-    virtual void onRideStatusChanged(shared_ptr<Ride> ride) = 0;
-    virtual void onDriverAssigned(shared_ptr<Ride> ride) = 0;
-    virtual void onPaymentCompleted(shared_ptr<Ride> ride) = 0;
+    virtual void onRideStatusChanged(const shared_ptr<Ride>& ride) = 0;
+    virtual void onDriverAssigned(const shared_ptr<Ride>& ride) = 0;
+    virtual void onPaymentCompleted(const shared_ptr<Ride>& ride) = 0;
+    
+    // A driver is asked to accept a ride; only called when offers are enabled
+    virtual void onRideOffered(const shared_ptr<Ride>&, const shared_ptr<Driver>&) {}
 };
 
 class RiderNotificationService : public NotificationObserver {
 public:
-    void onRideStatusChanged(shared_ptr<Ride> ride) override {
+    void onRideStatusChanged(const shared_ptr<Ride>& ride) override {
         cout << "[RIDER NOTIFICATION] Ride " << ride->getRideId() 
              << " status changed to: " << ride->getStatusString() << endl;
     }
     
-    void onDriverAssigned(shared_ptr<Ride> ride) override {
+    void onDriverAssigned(const shared_ptr<Ride>& ride) override {
         cout << "[RIDER NOTIFICATION] Driver " << ride->getDriver()->getName()
              << " has been assigned to your ride " << ride->getRideId() << endl;
     }
     
-    void onPaymentCompleted(shared_ptr<Ride> ride) override {
+    void onPaymentCompleted(const shared_ptr<Ride>& ride) override {
         cout << "[RIDER NOTIFICATION] Payment of $" << ride->getFare()
              << " completed for ride " << ride->getRideId() << endl;
     }
@@ -31,22 +34,27 @@ public:
 
 class DriverNotificationService : public NotificationObserver {
 public:
-    void onRideStatusChanged(shared_ptr<Ride> ride) override {
+    void onRideStatusChanged(const shared_ptr<Ride>& ride) override {
         if (ride->getDriver()) {
             cout << "[DRIVER NOTIFICATION] Ride " << ride->getRideId() 
                  << " status changed to: " << ride->getStatusString() << endl;
         }
     }
     
-    void onDriverAssigned(shared_ptr<Ride> ride) override {
+    void onDriverAssigned(const shared_ptr<Ride>& ride) override {
         cout << "[DRIVER NOTIFICATION] You have been assigned to ride " 
              << ride->getRideId() << endl;
     }
     
-    void onPaymentCompleted(shared_ptr<Ride> ride) override {
+    void onPaymentCompleted(const shared_ptr<Ride>& ride) override {
         cout << "[DRIVER NOTIFICATION] Payment received for ride " 
              << ride->getRideId() << endl;
     }
+    
+    void onRideOffered(const shared_ptr<Ride>& ride, const shared_ptr<Driver>& driver) override {
+        cout << "[DRIVER NOTIFICATION] " << driver->getName() << ", you have a new ride offer "
+             << ride->getRideId() << endl;
+    }
 };
 
 #endif
@@ -2,37 +2,56 @@
 #define FARE_CALCULATOR_H
 
 #include "../rides/ride.h"
+#include "../geofence/geofence_index.h"
+#include <cassert>
 
 class FareCalculator {
 public:
     virtual ~FareCalculator() = default;
     virtual double calculateFare(const Ride& ride) = 0;
-    virtual string getDescription() const = 0;
+    virtual const string& getDescription() const = 0;
+    
+    // Combined surge multiplier applied by this calculator chain (1.0 = no surge)
+    virtual double getSurgeMultiplier() const { return 1.0; }
+};
+
+// Which distance a fare is billed on
+enum class FareDistance {
+    STRAIGHT_LINE,  // pickup to dropoff
+    TRACED_PATH     // recorded GPS route, falling back to straight line without one
 };
 
 class BaseFareCalculator : public FareCalculator {
 private:
     double baseFare;
     double perKmRate;
+    FareDistance distanceMode;
+    string description;
 
 public:
-    BaseFareCalculator(double base = 50.0, double rate = 10.0)
-        : baseFare(base), perKmRate(rate) {}
+    BaseFareCalculator(double base = 50.0, double rate = 10.0,
+                       FareDistance mode = FareDistance::STRAIGHT_LINE)
+        : baseFare(base), perKmRate(rate), distanceMode(mode),
+          description(mode == FareDistance::TRACED_PATH ? "Base Fare Calculator (Traced Distance)"
+                                                        : "Base Fare Calculator") {}
     
     double calculateFare(const Ride& ride) override {
-        double distance = ride.getDistance();
+        double distance = (distanceMode == FareDistance::TRACED_PATH && ride.hasTracedDistance())
+            ? ride.getTracedDistance() : ride.getDistance();
         double vehicleMultiplier = 1.0;
         
         // Apply vehicle type multiplier
         if (ride.getDriver() && ride.getDriver()->getVehicle()) {
             vehicleMultiplier = ride.getDriver()->getVehicle()->getBaseFareRate() / 10.0;
+        } else {
+            vehicleMultiplier = Vehicle::getDefaultFareRate(ride.getRequestedVehicleType()) / 10.0;
         }
         
         return (baseFare + (distance * perKmRate)) * vehicleMultiplier;
     }
     
-    string getDescription() const override {
-        return "Base Fare Calculator";
+    const string& getDescription() const override {
+        return description;
     }
 };
 
@@ -40,10 +59,19 @@ public:
 class FareDecorator : public FareCalculator {
 protected:
     unique_ptr<FareCalculator> baseCalculator;
+    string description;     // composed once so getDescription() never allocates
 
 public:
-    FareDecorator(unique_ptr<FareCalculator> calc)
-        : baseCalculator(move(calc)) {}
+    FareDecorator(unique_ptr<FareCalculator> calc, const string& suffix)
+        : baseCalculator(move(calc)), description(baseCalculator->getDescription() + suffix) {}
+    
+    const string& getDescription() const override {
+        return description;
+    }
+    
+    double getSurgeMultiplier() const override {
+        return baseCalculator->getSurgeMultiplier();
+    }
 };
 
 class SurgePricingDecorator : public FareDecorator {
@@ -52,15 +80,34 @@ private:
 
 public:
     SurgePricingDecorator(unique_ptr<FareCalculator> calc, double multiplier = 1.5)
-        : FareDecorator(move(calc)), surgeMultiplier(multiplier) {}
+        : FareDecorator(move(calc), " + Surge Pricing"), surgeMultiplier(multiplier) {}
     
     double calculateFare(const Ride& ride) override {
         double baseFare = baseCalculator->calculateFare(ride);
         return baseFare * surgeMultiplier;
     }
     
-    string getDescription() const override {
-        return baseCalculator->getDescription() + " + Surge Pricing";
+    double getSurgeMultiplier() const override {
+        return baseCalculator->getSurgeMultiplier() * surgeMultiplier;
+    }
+};
+
+// Adds the surcharge of the special-fare zone (airport, station) the ride
+// was picked up in
+class ZoneSurchargeDecorator : public FareDecorator {
+private:
+    shared_ptr<const GeofenceIndex> geofence;   // shared so the zones outlive any config using them
+
+public:
+    // 'zones' must not be null; wrap a calculator only when zones are loaded
+    ZoneSurchargeDecorator(unique_ptr<FareCalculator> calc, shared_ptr<const GeofenceIndex> zones)
+        : FareDecorator(move(calc), " + Zone Surcharge"), geofence(move(zones)) {
+        assert(geofence && "ZoneSurchargeDecorator needs a zone index");
+    }
+    
+    double calculateFare(const Ride& ride) override {
+        double baseFare = baseCalculator->calculateFare(ride);
+        return baseFare + geofence->getPickupSurcharge(ride.getPickupLocation());
     }
 };
 
@@ -70,16 +117,12 @@ private:
 
 public:
     DiscountDecorator(unique_ptr<FareCalculator> calc, double discount = 0.1)
-        : FareDecorator(move(calc)), discountPercentage(discount) {}
+        : FareDecorator(move(calc), " + Discount Applied"), discountPercentage(discount) {}
     
     double calculateFare(const Ride& ride) override {
         double baseFare = baseCalculator->calculateFare(ride);
         return baseFare * (1.0 - discountPercentage);
     }
-    
-    string getDescription() const override {
-        return baseCalculator->getDescription() + " + Discount Applied";
-    }
 };
 
 #endif
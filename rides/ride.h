@@ -4,8 +4,12 @@
 #include "../common/types.h"
 #include "../users/rider.h"
 #include "../users/driver.h"
+#include "../timers/timer_wheel.h"
+#include "../common/pool_allocator.h"
+#include "../tracking/gps_trace.h"
 #include <chrono>
 #include <limits>
+#include <unordered_map>
 
 class Ride {
 private:
@@ -15,19 +19,24 @@ private:
     Location pickupLocation;
     Location dropoffLocation;
     RideStatus status;
+    CancellationReason cancellationReason;
+    TimerId timeoutTimer;   // pending lifecycle deadline, if any
     RideType rideType;
     VehicleType requestedVehicleType;
     double fare;
+    double surgeMultiplier;
     chrono::system_clock::time_point requestTime;
     chrono::system_clock::time_point startTime;
     chrono::system_clock::time_point endTime;
+    GpsTrace trace;         // route driven while IN_PROGRESS
 
 public:
     Ride(const string& id, shared_ptr<Rider> r, const Location& pickup,
          const Location& dropoff, VehicleType vehicleType, RideType type = RideType::NORMAL)
         : rideId(id), rider(r), pickupLocation(pickup), dropoffLocation(dropoff),
-          status(RideStatus::REQUESTED), rideType(type), requestedVehicleType(vehicleType),
-          fare(0.0), requestTime(chrono::system_clock::now()) {}
+          status(RideStatus::REQUESTED), cancellationReason(CancellationReason::NONE),
+          timeoutTimer(INVALID_TIMER_ID), rideType(type), requestedVehicleType(vehicleType),
+          fare(0.0), surgeMultiplier(1.0), requestTime(chrono::system_clock::now()) {}
     
     // Getters
     const string& getRideId() const { return rideId; }
@@ -36,14 +45,23 @@ public:
     const Location& getPickupLocation() const { return pickupLocation; }
     const Location& getDropoffLocation() const { return dropoffLocation; }
     RideStatus getStatus() const { return status; }
+    CancellationReason getCancellationReason() const { return cancellationReason; }
+    TimerId getTimeoutTimer() const { return timeoutTimer; }
     RideType getRideType() const { return rideType; }
     VehicleType getRequestedVehicleType() const { return requestedVehicleType; }
     double getFare() const { return fare; }
+    double getSurgeMultiplier() const { return surgeMultiplier; }
+    chrono::system_clock::time_point getRequestTime() const { return requestTime; }
+    chrono::system_clock::time_point getStartTime() const { return startTime; }
+    chrono::system_clock::time_point getEndTime() const { return endTime; }
+    const GpsTrace& getTrace() const { return trace; }
     
     // Setters
     void setDriver(shared_ptr<Driver> d) { driver = d; }
     void setStatus(RideStatus s) { status = s; }
     void setFare(double f) { fare = f; }
+    void setSurgeMultiplier(double m) { surgeMultiplier = m; }
+    void setTimeoutTimer(TimerId id) { timeoutTimer = id; }
     
     void startRide() {
         startTime = chrono::system_clock::now();
@@ -55,10 +73,31 @@ public:
         status = RideStatus::COMPLETED;
     }
     
+    void cancel(CancellationReason reason) {
+        endTime = chrono::system_clock::now();
+        status = RideStatus::CANCELLED;
+        cancellationReason = reason;
+    }
+    
+    bool isActive() const {
+        return status != RideStatus::COMPLETED && status != RideStatus::CANCELLED;
+    }
+    
     double getDistance() const {
         return pickupLocation.distanceTo(dropoffLocation);
     }
     
+    // Only positions reported while the trip is in progress become part of the route
+    bool recordLocation(const Location& location, chrono::system_clock::time_point time) {
+        if (status != RideStatus::IN_PROGRESS) return false;
+        trace.append(location, time);
+        return true;
+    }
+    
+    // Distance along the recorded route; needs at least two points
+    bool hasTracedDistance() const { return trace.getPointCount() >= 2; }
+    double getTracedDistance() const { return trace.getPathLengthKm(); }
+    
     string getStatusString() const {
         switch (status) {
             case RideStatus::REQUESTED: return "Requested";
@@ -70,6 +109,24 @@ public:
             default: return "Unknown";
         }
     }
+    
+    string getCancellationReasonString() const {
+        switch (cancellationReason) {
+            case CancellationReason::NONE: return "None";
+            case CancellationReason::RIDER_CANCELLED: return "Cancelled by rider";
+            case CancellationReason::DRIVER_CANCELLED: return "Cancelled by driver";
+            case CancellationReason::ASSIGNMENT_TIMEOUT: return "Driver did not start towards pickup";
+            case CancellationReason::PICKUP_TIMEOUT: return "Driver did not reach pickup in time";
+            case CancellationReason::RIDER_NO_SHOW: return "Rider did not show up";
+            case CancellationReason::NO_DRIVER_ACCEPTED: return "No driver accepted the offer";
+            default: return "Unknown";
+        }
+    }
 };
 
+// Ride registry keyed by ride ID; nodes come from a pool so inserting a ride
+// does not hit the global heap once the pool is reserved
+typedef unordered_map<string, shared_ptr<Ride>, hash<string>, equal_to<string>,
+                      PoolAllocator<pair<const string, shared_ptr<Ride>>>> RideMap;
+
 #endif
@@ -0,0 +1,250 @@
+#ifndef SHARED_DRIVER_TABLE_H
+#define SHARED_DRIVER_TABLE_H
+
+#include "../users/driver.h"
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define SHARED_DRIVER_TABLE_SUPPORTED 1
+#else
+#define SHARED_DRIVER_TABLE_SUPPORTED 0
+#endif
+
+// Plain copy of one driver's state as read out of the shared table
+struct DriverSnapshot {
+    char driverId[16];
+    DriverStatus status;
+    VehicleType vehicleType;
+    double latitude;
+    double longitude;
+    double rating;
+    uint64_t version;       // bumped on every update of this driver
+};
+
+// One cache line per driver. 'sequence' is the seqlock: odd while the writer
+// is mid-update, so readers retry instead of seeing a torn record.
+struct DriverStateRecord {
+    atomic<uint32_t> sequence;
+    uint8_t status;
+    uint8_t vehicleType;
+    uint16_t reserved;
+    uint64_t version;
+    char driverId[16];
+    double latitude;
+    double longitude;
+    double rating;
+    char padding[8];
+};
+
+static_assert(sizeof(DriverStateRecord) == 64, "DriverStateRecord must fill one cache line");
+static_assert(sizeof(atomic<uint32_t>) == sizeof(uint32_t), "atomics must be address-free");
+
+struct DriverTableHeader {
+    uint64_t magic;
+    uint32_t layoutVersion;
+    uint32_t capacity;
+    atomic<uint32_t> driverCount;   // records [0, driverCount) are initialized
+    char padding[44];
+};
+
+static_assert(sizeof(DriverTableHeader) == 64, "DriverTableHeader must fill one cache line");
+
+// Driver state table in a POSIX shared-memory segment. The RideManager
+// process is the single writer; any number of local processes can map the
+// segment read-only and take consistent per-driver snapshots straight from
+// shared memory, without IPC round trips or locks.
+class SharedDriverTable {
+private:
+    static const uint64_t MAGIC = 0x52534452564442ULL;     // "RSDRVDB"
+    static const uint32_t LAYOUT_VERSION = 1;
+    // A writer holds a record for a few dozen stores; one that died mid-update
+    // leaves the sequence odd forever, so readers give up after this many tries
+    static const unsigned MAX_READ_ATTEMPTS = 1u << 16;
+
+    string segmentName;
+    void* mapping;
+    size_t mappingSize;
+    bool writable;
+    DriverTableHeader* header;
+    DriverStateRecord* records;
+    unordered_map<string, uint32_t> slotByDriverId;   // writer side only
+
+    SharedDriverTable(const string& name, void* base, size_t size, bool owner)
+        : segmentName(name), mapping(base), mappingSize(size), writable(owner),
+          header(static_cast<DriverTableHeader*>(base)),
+          records(reinterpret_cast<DriverStateRecord*>(static_cast<char*>(base) +
+                                                       sizeof(DriverTableHeader))) {}
+
+    static size_t segmentSize(uint32_t capacity) {
+        return sizeof(DriverTableHeader) + capacity * sizeof(DriverStateRecord);
+    }
+
+public:
+    SharedDriverTable(const SharedDriverTable&) = delete;
+    SharedDriverTable& operator=(const SharedDriverTable&) = delete;
+
+    ~SharedDriverTable() {
+#if SHARED_DRIVER_TABLE_SUPPORTED
+        munmap(mapping, mappingSize);
+        if (writable) shm_unlink(segmentName.c_str());
+#endif
+    }
+
+    // Creates (or replaces) the segment; returns nullptr if shared memory is
+    // unavailable. The segment is unlinked when the writer's table is destroyed.
+    static unique_ptr<SharedDriverTable> create(const string& name, uint32_t capacity) {
+#if SHARED_DRIVER_TABLE_SUPPORTED
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0) return nullptr;
+
+        size_t size = segmentSize(capacity);
+        if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+
+        void* base = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            return nullptr;
+        }
+
+        // ftruncate zero-fills, which is a valid initial state for the atomics
+        unique_ptr<SharedDriverTable> table(new SharedDriverTable(name, base, size, true));
+        table->header->capacity = capacity;
+        table->header->layoutVersion = LAYOUT_VERSION;
+        table->header->driverCount.store(0, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        table->header->magic = MAGIC;
+        return table;
+#else
+        (void)name;
+        (void)capacity;
+        return nullptr;
+#endif
+    }
+
+    // Maps an existing segment read-only; returns nullptr if it is missing or
+    // was written by an incompatible layout
+    static unique_ptr<SharedDriverTable> openReadOnly(const string& name) {
+#if SHARED_DRIVER_TABLE_SUPPORTED
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0) return nullptr;
+
+        struct stat info;
+        if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(DriverTableHeader)) {
+            close(fd);
+            return nullptr;
+        }
+
+        size_t size = static_cast<size_t>(info.st_size);
+        void* base = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        close(fd);
+        if (base == MAP_FAILED) return nullptr;
+
+        unique_ptr<SharedDriverTable> table(new SharedDriverTable(name, base, size, false));
+        const DriverTableHeader* h = table->header;
+        if (h->magic != MAGIC || h->layoutVersion != LAYOUT_VERSION ||
+            segmentSize(h->capacity) > size) {
+            return nullptr;
+        }
+        return table;
+#else
+        (void)name;
+        return nullptr;
+#endif
+    }
+
+    uint32_t getCapacity() const { return header->capacity; }
+    uint32_t getDriverCount() const { return header->driverCount.load(memory_order_acquire); }
+    const string& getSegmentName() const { return segmentName; }
+
+    // Writer: adds or updates a driver's record; returns false when the table is full
+    bool publish(const Driver& driver) {
+        if (!writable) return false;
+
+        uint32_t slot;
+        auto it = slotByDriverId.find(driver.getUserId());
+        if (it != slotByDriverId.end()) {
+            slot = it->second;
+        } else {
+            slot = header->driverCount.load(memory_order_relaxed);
+            if (slot >= header->capacity) return false;
+            slotByDriverId.emplace(driver.getUserId(), slot);
+        }
+
+        DriverStateRecord& record = records[slot];
+        uint32_t seq = record.sequence.load(memory_order_relaxed);
+        record.sequence.store(seq + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+
+        memset(record.driverId, 0, sizeof(record.driverId));
+        strncpy(record.driverId, driver.getUserId().c_str(), sizeof(record.driverId) - 1);
+        record.status = static_cast<uint8_t>(driver.getStatus());
+        record.vehicleType = driver.getVehicle()
+            ? static_cast<uint8_t>(driver.getVehicle()->getType()) : 0;
+        record.latitude = driver.getCurrentLocation().latitude;
+        record.longitude = driver.getCurrentLocation().longitude;
+        record.rating = driver.getRating();
+        record.version++;
+
+        record.sequence.store(seq + 2, memory_order_release);
+
+        // A new slot becomes visible only once its first record is complete
+        if (slot == header->driverCount.load(memory_order_relaxed)) {
+            header->driverCount.store(slot + 1, memory_order_release);
+        }
+        return true;
+    }
+
+    // Reader: copies a consistent snapshot of one slot, retrying while the
+    // writer is mid-update. Returns false for slots not yet published, and for
+    // a slot that stays mid-update for MAX_READ_ATTEMPTS tries (writer died).
+    bool readSnapshot(uint32_t slot, DriverSnapshot& snapshot) const {
+        if (slot >= getDriverCount()) return false;
+
+        const DriverStateRecord& record = records[slot];
+        for (unsigned attempt = 0; attempt < MAX_READ_ATTEMPTS; attempt++) {
+            uint32_t before = record.sequence.load(memory_order_acquire);
+            if (before & 1) continue;
+
+            memcpy(snapshot.driverId, record.driverId, sizeof(snapshot.driverId));
+            snapshot.status = static_cast<DriverStatus>(record.status);
+            snapshot.vehicleType = static_cast<VehicleType>(record.vehicleType);
+            snapshot.latitude = record.latitude;
+            snapshot.longitude = record.longitude;
+            snapshot.rating = record.rating;
+            snapshot.version = record.version;
+
+            atomic_thread_fence(memory_order_acquire);
+            if (record.sequence.load(memory_order_relaxed) == before) return true;
+        }
+        return false;
+    }
+
+    // Reader: visits a consistent snapshot of every published driver; returns
+    // how many published slots could not be read
+    template <typename Visitor>
+    uint32_t forEachDriver(Visitor visit) const {
+        DriverSnapshot snapshot;
+        uint32_t count = getDriverCount();
+        uint32_t unreadable = 0;
+        for (uint32_t slot = 0; slot < count; slot++) {
+            if (readSnapshot(slot, snapshot)) visit(snapshot);
+            else unreadable++;
+        }
+        return unreadable;
+    }
+};
+
+#endif
@@ -6,13 +6,67 @@
 #include <vector>
 #include <algorithm>
 
+// One entry of a ranked candidate list; lower scores rank first
+struct DriverCandidate {
+    shared_ptr<Driver> driver;
+    double score;
+
+    DriverCandidate(shared_ptr<Driver> d = nullptr, double s = 0.0) : driver(move(d)), score(s) {}
+};
+
 class MatchingStrategy {
+protected:
+    static bool isEligible(const Driver& driver, const Ride& ride) {
+        return driver.isAvailable() &&
+               driver.getVehicle()->getType() == ride.getRequestedVehicleType();
+    }
+    
+    // Keeps the k best-scoring eligible drivers in a bounded max-heap (worst
+    // on top), so one pass costs O(n log k); 'ranked' ends up sorted best first
+    template <typename ScoreFn>
+    static void selectTopDrivers(const vector<shared_ptr<Driver>>& availableDrivers,
+                                 const Ride& ride, size_t k,
+                                 vector<DriverCandidate>& ranked, ScoreFn score) {
+        ranked.clear();
+        if (k == 0) return;
+        
+        auto worse = [](const DriverCandidate& a, const DriverCandidate& b) {
+            return a.score < b.score;
+        };
+        for (const auto& driver : availableDrivers) {
+            if (!isEligible(*driver, ride)) continue;
+            
+            double s = score(*driver);
+            if (ranked.size() < k) {
+                ranked.emplace_back(driver, s);
+                push_heap(ranked.begin(), ranked.end(), worse);
+            } else if (s < ranked.front().score) {
+                pop_heap(ranked.begin(), ranked.end(), worse);
+                ranked.back() = DriverCandidate(driver, s);
+                push_heap(ranked.begin(), ranked.end(), worse);
+            }
+        }
+        sort_heap(ranked.begin(), ranked.end(), worse);
+    }
+
 public:
     virtual ~MatchingStrategy() = default;
     virtual shared_ptr<Driver> findBestDriver(
         const vector<shared_ptr<Driver>>& availableDrivers,
         const Ride& ride) = 0;
-    virtual string getStrategyName() const = 0;
+    
+    // Up to k eligible drivers, best first, from a single scan. 'ranked' is
+    // cleared and reused so callers can keep its capacity. Strategies without
+    // a ranking only return their single best driver.
+    virtual void rankDrivers(const vector<shared_ptr<Driver>>& availableDrivers,
+                             const Ride& ride, size_t k, vector<DriverCandidate>& ranked) {
+        ranked.clear();
+        if (k == 0) return;
+        auto best = findBestDriver(availableDrivers, ride);
+        if (best) ranked.emplace_back(best, 0.0);
+    }
+    
+    virtual const string& getStrategyName() const = 0;
 };
 
 class NearestDriverStrategy : public MatchingStrategy {
@@ -42,8 +96,17 @@ public:
         return bestDriver;
     }
     
-    string getStrategyName() const override {
-        return "Nearest Driver Strategy";
+    void rankDrivers(const vector<shared_ptr<Driver>>& availableDrivers,
+                     const Ride& ride, size_t k, vector<DriverCandidate>& ranked) override {
+        const Location& pickup = ride.getPickupLocation();
+        selectTopDrivers(availableDrivers, ride, k, ranked, [&pickup](const Driver& driver) {
+            return driver.getCurrentLocation().distanceTo(pickup);
+        });
+    }
+    
+    const string& getStrategyName() const override {
+        static const string name = "Nearest Driver Strategy";
+        return name;
     }
 };
 
@@ -73,8 +136,16 @@ public:
         return bestDriver;
     }
     
-    string getStrategyName() const override {
-        return "Highest Rated Driver Strategy";
+    void rankDrivers(const vector<shared_ptr<Driver>>& availableDrivers,
+                     const Ride& ride, size_t k, vector<DriverCandidate>& ranked) override {
+        selectTopDrivers(availableDrivers, ride, k, ranked, [](const Driver& driver) {
+            return -driver.getRating();
+        });
+    }
+    
+    const string& getStrategyName() const override {
+        static const string name = "Highest Rated Driver Strategy";
+        return name;
     }
 };
 
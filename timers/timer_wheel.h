@@ -0,0 +1,221 @@
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+using namespace std;
+
+typedef uint64_t TimerId;
+const TimerId INVALID_TIMER_ID = 0;
+
+// Hierarchical timing wheel (256 + 3 x 64 slots, ~2^26 ticks of range).
+// Timers live in a pooled, index-linked array so arming and cancelling are
+// O(1) and never touch other timers. Far timers sit in coarse levels and are
+// cascaded into finer ones as the wheel turns. A TimerId carries a generation
+// counter, so cancelling an already-fired or reused id is a harmless no-op.
+template <typename Payload>
+class TimerWheel {
+private:
+    static const uint32_t NIL = 0xFFFFFFFFu;
+    static const unsigned LEVEL0_BITS = 8;
+    static const unsigned LEVELN_BITS = 6;
+    static const unsigned LEVELS = 4;
+    static const uint64_t LEVEL0_SIZE = 1ULL << LEVEL0_BITS;
+    static const uint64_t LEVELN_SIZE = 1ULL << LEVELN_BITS;
+    static const uint64_t MAX_SPAN = 1ULL << (LEVEL0_BITS + (LEVELS - 1) * LEVELN_BITS);
+
+    struct Entry {
+        uint64_t expiryTick;
+        uint32_t prev;
+        uint32_t next;
+        uint32_t generation;
+        uint32_t bucket;    // NIL while on the free list
+        Payload payload;
+    };
+
+    vector<Entry> entries;
+    vector<uint32_t> buckets;   // list head per slot, all levels flattened
+    uint32_t freeHead;
+    size_t activeCount;
+
+    chrono::steady_clock::time_point origin;
+    chrono::milliseconds tickSize;
+    uint64_t currentTick;       // last tick fully processed
+
+    static uint32_t bucketIndex(unsigned level, uint64_t slot) {
+        return level == 0
+            ? static_cast<uint32_t>(slot)
+            : static_cast<uint32_t>(LEVEL0_SIZE + (level - 1) * LEVELN_SIZE + slot);
+    }
+
+    static TimerId makeId(uint32_t index, uint32_t generation) {
+        return (static_cast<uint64_t>(generation) << 32) | (static_cast<uint64_t>(index) + 1);
+    }
+
+    void link(uint32_t index) {
+        Entry& e = entries[index];
+        uint64_t delta = e.expiryTick - currentTick;
+        if (delta >= MAX_SPAN) delta = MAX_SPAN - 1;    // re-cascaded until due
+        uint64_t tick = currentTick + delta;
+
+        uint32_t bucket;
+        if (delta < LEVEL0_SIZE) {
+            bucket = bucketIndex(0, tick & (LEVEL0_SIZE - 1));
+        } else {
+            unsigned level = 1;
+            unsigned shift = LEVEL0_BITS;
+            while (level < LEVELS - 1 && delta >= (1ULL << (shift + LEVELN_BITS))) {
+                level++;
+                shift += LEVELN_BITS;
+            }
+            bucket = bucketIndex(level, (tick >> shift) & (LEVELN_SIZE - 1));
+        }
+
+        e.bucket = bucket;
+        e.prev = NIL;
+        e.next = buckets[bucket];
+        if (e.next != NIL) entries[e.next].prev = index;
+        buckets[bucket] = index;
+    }
+
+    void unlink(uint32_t index) {
+        Entry& e = entries[index];
+        if (e.prev != NIL) {
+            entries[e.prev].next = e.next;
+        } else {
+            buckets[e.bucket] = e.next;
+        }
+        if (e.next != NIL) entries[e.next].prev = e.prev;
+    }
+
+    void release(uint32_t index) {
+        Entry& e = entries[index];
+        e.bucket = NIL;
+        e.generation++;
+        e.payload = Payload();
+        e.next = freeHead;
+        freeHead = index;
+        activeCount--;
+    }
+
+    void cascade(unsigned level, uint64_t slot) {
+        uint32_t bucket = bucketIndex(level, slot);
+        uint32_t index = buckets[bucket];
+        buckets[bucket] = NIL;
+        while (index != NIL) {
+            uint32_t next = entries[index].next;
+            link(index);
+            index = next;
+        }
+    }
+
+    template <typename Callback>
+    size_t step(Callback& onExpire) {
+        currentTick++;
+
+        // Pull due timers down from coarser levels at each level boundary
+        unsigned shift = LEVEL0_BITS;
+        for (unsigned level = 1; level < LEVELS; level++) {
+            if ((currentTick & ((1ULL << shift) - 1)) != 0) break;
+            cascade(level, (currentTick >> shift) & (LEVELN_SIZE - 1));
+            shift += LEVELN_BITS;
+        }
+
+        size_t fired = 0;
+        uint32_t bucket = bucketIndex(0, currentTick & (LEVEL0_SIZE - 1));
+        while (buckets[bucket] != NIL) {
+            uint32_t index = buckets[bucket];
+            unlink(index);
+            Payload payload = move(entries[index].payload);
+            release(index);
+            // Callback may arm or cancel timers, so the entry is released first
+            onExpire(payload);
+            fired++;
+        }
+        return fired;
+    }
+
+public:
+    explicit TimerWheel(chrono::milliseconds tick = chrono::milliseconds(100),
+                        chrono::steady_clock::time_point start = chrono::steady_clock::now())
+        : buckets(LEVEL0_SIZE + (LEVELS - 1) * LEVELN_SIZE, NIL), freeHead(NIL),
+          activeCount(0), origin(start), tickSize(tick), currentTick(0) {}
+
+    size_t size() const { return activeCount; }
+
+    void reserve(size_t timers) { entries.reserve(timers); }
+
+    // Last tick boundary at or before 'time'; advance() may run through it
+    uint64_t toTick(chrono::steady_clock::time_point time) const {
+        if (time <= origin) return 0;
+        return static_cast<uint64_t>((time - origin) / tickSize);
+    }
+
+    // First tick boundary at or after 'time'; a deadline armed there cannot
+    // fire before it is due
+    uint64_t toTickCeil(chrono::steady_clock::time_point time) const {
+        if (time <= origin) return 0;
+        auto elapsed = time - origin;
+        uint64_t tick = static_cast<uint64_t>(elapsed / tickSize);
+        return (elapsed % tickSize == decltype(elapsed)::zero()) ? tick : tick + 1;
+    }
+
+    // Arms a timer that fires on the first advance() at or after 'deadline'
+    TimerId schedule(chrono::steady_clock::time_point deadline, Payload payload) {
+        uint32_t index;
+        if (freeHead != NIL) {
+            index = freeHead;
+            freeHead = entries[index].next;
+        } else {
+            index = static_cast<uint32_t>(entries.size());
+            entries.push_back(Entry());
+            entries[index].generation = 0;
+        }
+
+        Entry& e = entries[index];
+        uint64_t tick = toTickCeil(deadline);
+        e.expiryTick = tick > currentTick ? tick : currentTick + 1;
+        e.payload = move(payload);
+        link(index);
+        activeCount++;
+        return makeId(index, e.generation);
+    }
+
+    // Returns false if the timer already fired or was cancelled
+    bool cancel(TimerId id) {
+        if (id == INVALID_TIMER_ID) return false;
+
+        uint32_t index = static_cast<uint32_t>((id & 0xFFFFFFFFu) - 1);
+        uint32_t generation = static_cast<uint32_t>(id >> 32);
+        if (index >= entries.size()) return false;
+
+        Entry& e = entries[index];
+        if (e.generation != generation || e.bucket == NIL) return false;
+
+        unlink(index);
+        release(index);
+        return true;
+    }
+
+    // Fires every timer due at or before 'now'; returns how many fired
+    template <typename Callback>
+    size_t advance(chrono::steady_clock::time_point now, Callback onExpire) {
+        uint64_t target = toTick(now);
+        size_t fired = 0;
+        while (currentTick < target) {
+            if (activeCount == 0) {
+                currentTick = target;
+                break;
+            }
+            fired += step(onExpire);
+        }
+        return fired;
+    }
+};
+
+template <typename Payload> const uint32_t TimerWheel<Payload>::NIL;
+template <typename Payload> const uint64_t TimerWheel<Payload>::MAX_SPAN;
+
+#endif
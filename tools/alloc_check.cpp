@@ -0,0 +1,181 @@
+// Verifies that the request -> start -> GPS updates -> complete ride lifecycle
+// performs no heap allocations once RideManager is reserved and warmed up,
+// both with direct assignment and through the offer cascade (decline, then
+// accept). Storage is reserved for a fixed number of rides and the check runs
+// many times that many lifecycles, so it only passes if finished rides are
+// evicted and recycled rather than fitting into the reservation.
+// Installs a counting global allocator and exits non-zero if steady-state
+// rides allocate.
+// Usage: alloc_check [lifecycles per mode]
+
+#include "managers/ride_manager.h"
+#include "factories/vehicle_factory.h"
+#include <atomic>
+#include <cstdlib>
+#include <functional>
+#include <new>
+
+// malloc/free back the replacement operators, which GCC misreads as a mismatch
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 11
+#pragma GCC diagnostic ignored "-Wmismatched-new-delete"
+#endif
+
+static atomic<bool> countingEnabled(false);
+static atomic<size_t> allocationCount(0);
+
+void* operator new(size_t size) {
+    if (countingEnabled.load(memory_order_relaxed)) {
+        allocationCount.fetch_add(1, memory_order_relaxed);
+    }
+    if (void* p = malloc(size ? size : 1)) return p;
+    throw bad_alloc();
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept {
+    try {
+        return operator new(size);
+    } catch (...) {
+        return nullptr;
+    }
+}
+
+void* operator new[](size_t size, const nothrow_t&) noexcept {
+    return operator new(size, nothrow);
+}
+
+void operator delete(void* p) noexcept { free(p); }
+void operator delete[](void* p) noexcept { free(p); }
+void operator delete(void* p, size_t) noexcept { free(p); }
+void operator delete[](void* p, size_t) noexcept { free(p); }
+
+// Observer that only touches the ride, so notification cost is part of the check
+class CountingObserver : public NotificationObserver {
+public:
+    size_t events = 0;
+
+    void onRideStatusChanged(const shared_ptr<Ride>& ride) override {
+        if (ride->getStatus() != RideStatus::REQUESTED) events++;
+    }
+    void onDriverAssigned(const shared_ptr<Ride>& ride) override {
+        if (ride->getDriver()) events++;
+    }
+    void onPaymentCompleted(const shared_ptr<Ride>& ride) override {
+        if (ride->getFare() > 0.0) events++;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    size_t lifecycles = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 20000;
+    const size_t warmupLifecycles = 64;
+    const size_t retainedRides = 256;
+    const size_t historyPerUser = 64;
+    const size_t reservedRides = 2 * retainedRides;
+
+    Logger::getInstance()->open("alloc_check.log", LogLevel::DEBUG);
+
+    RideManager* rideManager = RideManager::getInstance();
+    auto observer = make_shared<CountingObserver>();
+    rideManager->addObserver(observer);
+    rideManager->setDemandHeatmap(make_shared<DemandHeatmap>(18.90, 72.77, 19.30, 73.05));
+    rideManager->setFareCalculator(make_unique<SurgePricingDecorator>(
+        make_unique<BaseFareCalculator>(), 1.5));
+
+    rideManager->addDriver(make_shared<Driver>("D001", "Mohit Garg", "9876543210",
+        Location(19.0760, 72.8777, "Mumbai Central"),
+        VehicleFactory::createVehicle(VehicleType::SEDAN, "V001", "MH01AB1234"), 4.8));
+    rideManager->addDriver(make_shared<Driver>("D002", "Parmeshwar Rane", "9876543211",
+        Location(19.0896, 72.8656, "Dadar"),
+        VehicleFactory::createVehicle(VehicleType::SEDAN, "V002", "MH01CD5678"), 4.9));
+    rideManager->addRider(make_shared<Rider>("R001", "Pratik Mandalkar", "9123456789",
+        Location(19.0728, 72.8826, "Fort"), 4.5));
+
+    rideManager->setRetentionPolicy(RideRetentionPolicy(retainedRides, historyPerUser));
+    rideManager->reserveRideCapacity(reservedRides, historyPerUser);
+
+    Location pickup(19.0760, 72.8777, "Gateway of India");
+    Location dropoff(19.0896, 72.8656, "Dadar Station");
+
+    auto driveRide = [&](const shared_ptr<Ride>& ride) {
+        rideManager->startRide(ride->getRideId());
+        const string& driverId = ride->getDriver()->getUserId();
+        for (int step = 1; step <= 4; step++) {
+            double t = step / 4.0;
+            rideManager->updateDriverLocation(driverId, Location(
+                pickup.latitude + t * (dropoff.latitude - pickup.latitude),
+                pickup.longitude + t * (dropoff.longitude - pickup.longitude)));
+        }
+        rideManager->completeRide(ride->getRideId());
+        return ride->getStatus() == RideStatus::COMPLETED;
+    };
+
+    auto directLifecycle = [&]() {
+        auto ride = rideManager->requestRide("R001", pickup, dropoff, VehicleType::SEDAN);
+        return ride && driveRide(ride);
+    };
+
+    // First candidate passes, the second accepts
+    auto offerLifecycle = [&]() {
+        auto ride = rideManager->requestRide("R001", pickup, dropoff, VehicleType::SEDAN);
+        if (!ride) return false;
+        const string& rideId = ride->getRideId();
+        shared_ptr<Driver> first = rideManager->getOfferedDriver(rideId);
+        if (!first || !rideManager->declineOffer(rideId, first->getUserId())) return false;
+        shared_ptr<Driver> second = rideManager->getOfferedDriver(rideId);
+        if (!second || !rideManager->acceptOffer(rideId, second->getUserId())) return false;
+        return driveRide(ride);
+    };
+
+    struct Mode {
+        const char* name;
+        size_t candidateCount;
+        function<bool()> lifecycle;
+    };
+    const Mode modes[] = {
+        {"direct assignment", 0, directLifecycle},
+        {"offer cascade", 2, offerLifecycle},
+    };
+
+    bool passed = true;
+    for (const Mode& mode : modes) {
+        OfferPolicy policy;
+        policy.candidateCount = mode.candidateCount;
+        rideManager->setOfferPolicy(policy);
+
+        for (size_t i = 0; i < warmupLifecycles; i++) {
+            if (!mode.lifecycle()) {
+                cerr << "Warm-up lifecycle failed (" << mode.name << ")" << endl;
+                return 1;
+            }
+        }
+
+        allocationCount.store(0);
+        countingEnabled.store(true);
+        size_t completed = 0;
+        for (size_t i = 0; i < lifecycles; i++) {
+            if (mode.lifecycle()) completed++;
+        }
+        countingEnabled.store(false);
+
+        size_t allocations = allocationCount.load();
+        size_t tracked = rideManager->getRides().size();
+        cout << "Steady-state lifecycles (" << mode.name << "): " << completed << "/" << lifecycles
+             << ", heap allocations: " << allocations << ", rides tracked: " << tracked << endl;
+        if (completed != lifecycles || allocations != 0 || tracked > retainedRides) passed = false;
+    }
+
+    Logger::getInstance()->close();
+    remove("alloc_check.log");
+
+    cout << "Ride storage reserved for " << reservedRides << " rides, " << retainedRides
+         << " finished rides retained" << endl;
+    if (!passed) {
+        cout << "FAILED" << endl;
+        return 1;
+    }
+    cout << "PASSED" << endl;
+    return 0;
+}
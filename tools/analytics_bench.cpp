@@ -0,0 +1,70 @@
+// Throughput check for the columnar ride analytics (analytics/ride_analytics.h).
+// Usage: analytics_bench [rows] [threads]
+
+#include "analytics/ride_analytics.h"
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+int main(int argc, char* argv[]) {
+    size_t rows = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 10000000;
+    unsigned threads = (argc > 2) ? static_cast<unsigned>(atoi(argv[2])) : 0;
+
+    const size_t driverCount = 50000;
+    const size_t riderCount = 200000;
+    vector<string> driverIds, riderIds;
+    for (size_t i = 0; i < driverCount; i++) driverIds.push_back("D" + to_string(i));
+    for (size_t i = 0; i < riderCount; i++) riderIds.push_back("R" + to_string(i));
+
+    mt19937_64 rng(42);
+    uniform_real_distribution<double> distanceDist(0.5, 30.0);
+    const int64_t dayStartMs = 1700000000000LL;
+
+    auto loadStart = chrono::steady_clock::now();
+    RideColumnStore store;
+    for (size_t i = 0; i < rows; i++) {
+        uint64_t r = rng();
+        double distance = distanceDist(rng);
+        double surge = (r & 7) == 0 ? 1.5 : 1.0;
+        int64_t start = dayStartMs + static_cast<int64_t>(r % 86400000ULL);
+        int64_t end = start + static_cast<int64_t>(distance * 120000);
+        store.appendRow((50.0 + distance * 10.0) * surge, distance, surge,
+                        static_cast<VehicleType>((r >> 8) % VEHICLE_TYPE_COUNT),
+                        start - 60000, start, end,
+                        driverIds[(r >> 16) % driverCount], riderIds[(r >> 32) % riderCount]);
+    }
+    auto loadEnd = chrono::steady_clock::now();
+
+    RideAnalytics analytics(store, threads);
+
+    auto timeIt = [](const char* label, size_t rowCount, function<void()> report) {
+        auto start = chrono::steady_clock::now();
+        report();
+        double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        cout << label << ": " << seconds * 1000.0 << " ms ("
+             << (rowCount / seconds) / 1e6 << " M rows/s)" << endl;
+    };
+
+    cout << "Loaded " << rows << " rides in "
+         << chrono::duration<double>(loadEnd - loadStart).count() << " s" << endl;
+
+    double checksum = 0.0;
+    timeIt("Revenue by vehicle type and hour", rows, [&]() {
+        for (const auto& g : analytics.revenueByVehicleTypeAndHour()) checksum += g.sum;
+    });
+    timeIt("Fare by surge state", rows, [&]() {
+        for (const auto& g : analytics.fareBySurgeState()) checksum += g.average();
+    });
+    timeIt("Driver utilization", rows, [&]() {
+        for (double u : analytics.driverUtilization(dayStartMs, dayStartMs + 86400000LL)) {
+            checksum += u;
+        }
+    });
+
+    cout << "Checksum: " << checksum << endl;
+    return 0;
+}
@@ -0,0 +1,49 @@
+// Reads driver state published by a running RideManager process through the
+// shared-memory table (shm/shared_driver_table.h).
+// Usage: driver_state_reader [segment name] [refresh count]
+
+#include "shm/shared_driver_table.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+using namespace std;
+
+static const char* statusString(DriverStatus status) {
+    switch (status) {
+        case DriverStatus::AVAILABLE: return "Available";
+        case DriverStatus::ON_TRIP: return "On Trip";
+        case DriverStatus::OFFLINE: return "Offline";
+        case DriverStatus::OFFERED: return "Offered";
+        default: return "Unknown";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    string segment = (argc > 1) ? argv[1] : "/rideshare_drivers";
+    int refreshes = (argc > 2) ? atoi(argv[2]) : 1;
+
+    auto table = SharedDriverTable::openReadOnly(segment);
+    if (!table) {
+        cerr << "Cannot open driver table " << segment << endl;
+        return 1;
+    }
+
+    for (int i = 0; i < refreshes; i++) {
+        if (i > 0) this_thread::sleep_for(chrono::seconds(1));
+
+        cout << "=== " << table->getDriverCount() << " drivers in " << segment << " ===" << endl;
+        uint32_t unreadable = table->forEachDriver([](const DriverSnapshot& driver) {
+            cout << setw(8) << driver.driverId << "  " << setw(10) << statusString(driver.status)
+                 << "  (" << fixed << setprecision(4) << driver.latitude << ", "
+                 << driver.longitude << ")  rating " << setprecision(1) << driver.rating
+                 << "  v" << driver.version << endl;
+        });
+        if (unreadable > 0) {
+            cout << unreadable << " record(s) stuck mid-update; did the writer exit abnormally?" << endl;
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+// Measures GeofenceIndex lookups over thousands of random zone polygons and
+// cross-checks every sampled result against a brute-force scan.
+// Usage: geofence_bench [zones] [lookups]
+
+#include "geofence/geofence_index.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+
+using namespace std;
+
+// Plain ray cast over every edge, independent of the banded implementation
+static bool naiveContains(const vector<Location>& polygon, double lat, double lng) {
+    bool inside = false;
+    for (size_t i = 0, j = polygon.size() - 1; i < polygon.size(); j = i++) {
+        const Location& a = polygon[i];
+        const Location& b = polygon[j];
+        if ((a.latitude > lat) != (b.latitude > lat)) {
+            double crossLng = a.longitude + (lat - a.latitude) * (b.longitude - a.longitude) /
+                                            (b.latitude - a.latitude);
+            if (lng < crossLng) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+// Star-shaped polygon around a center; each vertex radius is scaled by [roughness, 1]
+static vector<Location> randomPolygon(mt19937& rng, double lat, double lng, double radius,
+                                      size_t vertices, double roughness) {
+    uniform_real_distribution<double> jitter(roughness, 1.0);
+    vector<Location> polygon;
+    for (size_t i = 0; i < vertices; i++) {
+        double angle = 2.0 * M_PI * i / vertices;
+        double r = radius * jitter(rng);
+        polygon.emplace_back(lat + r * sin(angle), lng + r * cos(angle));
+    }
+    return polygon;
+}
+
+int main(int argc, char* argv[]) {
+    size_t zoneCount = (argc > 1) ? strtoull(argv[1], nullptr, 10) : 5000;
+    size_t lookups = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 1000000;
+
+    mt19937 rng(7);
+    uniform_real_distribution<double> lat(18.90, 19.30);
+    uniform_real_distribution<double> lng(72.77, 73.05);
+    uniform_real_distribution<double> radius(0.001, 0.005);    // roughly 100 - 500 m
+    uniform_int_distribution<size_t> vertexCount(8, 64);
+    const char* types[] = {"special_fare", "no_service"};
+
+    // One detailed city boundary plus many small zones, loaded through the text format
+    vector<vector<Location>> polygons;
+    polygons.push_back(randomPolygon(rng, 19.10, 72.91, 0.20, 2000, 0.97));
+    stringstream file;
+    file.precision(17);
+    file << "zone CITY service_area 0 all City\n";
+    for (const auto& v : polygons[0]) file << v.latitude << " " << v.longitude << "\n";
+    file << "end\n";
+    for (size_t z = 0; z < zoneCount; z++) {
+        polygons.push_back(randomPolygon(rng, lat(rng), lng(rng), radius(rng), vertexCount(rng), 0.4));
+        file << "zone Z" << z << " " << types[z % 2] << " " << (z % 7) * 10 << " sedan,suv Zone " << z << "\n";
+        for (const auto& v : polygons.back()) file << v.latitude << " " << v.longitude << "\n";
+        file << "end\n";
+    }
+
+    GeofenceIndex index;
+    string error;
+    auto loadStart = chrono::steady_clock::now();
+    if (!index.load(file, error)) {
+        cerr << "Load failed: " << error << endl;
+        return 1;
+    }
+    double loadMs = chrono::duration<double, milli>(chrono::steady_clock::now() - loadStart).count();
+    cout << "Loaded " << index.getZoneCount() << " zones, R-tree height " << index.getTreeHeight()
+         << " in " << loadMs << " ms" << endl;
+
+    // Sample points, then check the index against brute force on a subset
+    vector<Location> points;
+    points.reserve(lookups);
+    for (size_t i = 0; i < lookups; i++) points.emplace_back(lat(rng), lng(rng));
+
+    size_t verified = min<size_t>(lookups, 20000);
+    size_t mismatches = 0;
+    for (size_t i = 0; i < verified; i++) {
+        size_t indexed = 0;
+        index.forEachZoneAt(points[i], [&indexed](const GeoZone&) { indexed++; });
+        size_t brute = 0;
+        for (const auto& polygon : polygons) {
+            if (naiveContains(polygon, points[i].latitude, points[i].longitude)) brute++;
+        }
+        if (indexed != brute) mismatches++;
+    }
+
+    size_t allowed = 0;
+    double surcharges = 0.0;
+    auto start = chrono::steady_clock::now();
+    for (const auto& point : points) {
+        if (index.checkRequest(point, point, VehicleType::SEDAN).isAllowed()) allowed++;
+        surcharges += index.getPickupSurcharge(point);
+    }
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Verified " << verified << " points against brute force: " << mismatches
+         << " mismatches" << endl;
+    cout << "Lookups: " << lookups << " request checks + surcharges in " << seconds * 1000 << " ms ("
+         << seconds * 1e9 / lookups << " ns per request, " << allowed << " allowed, surcharge sum "
+         << surcharges << ")" << endl;
+    return mismatches == 0 ? 0 : 1;
+}
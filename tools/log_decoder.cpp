@@ -0,0 +1,117 @@
+// Offline decoder for the binary logs written by Logger (logging/logger.h).
+// Usage: log_decoder <rideshare.log>
+
+#include "logging/log_events.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+static vector<string> decodeArgs(const LogRecord& record) {
+    vector<string> args;
+    size_t offset = 0;
+
+    for (int i = 0; i < record.argCount && offset < LOG_PAYLOAD_SIZE; i++) {
+        LogArgType type = static_cast<LogArgType>(record.payload[offset++]);
+        ostringstream out;
+
+        if (type == LogArgType::INT && offset + 8 <= LOG_PAYLOAD_SIZE) {
+            int64_t value;
+            memcpy(&value, record.payload + offset, 8);
+            offset += 8;
+            out << value;
+        } else if (type == LogArgType::REAL && offset + 8 <= LOG_PAYLOAD_SIZE) {
+            double value;
+            memcpy(&value, record.payload + offset, 8);
+            offset += 8;
+            out << value;
+        } else if (type == LogArgType::TEXT && offset < LOG_PAYLOAD_SIZE) {
+            size_t length = record.payload[offset++];
+            length = min(length, LOG_PAYLOAD_SIZE - offset);
+            out << string(reinterpret_cast<const char*>(record.payload + offset), length);
+            offset += length;
+        } else {
+            break;
+        }
+        args.push_back(out.str());
+    }
+    return args;
+}
+
+static string formatMessage(const char* format, const vector<string>& args) {
+    string message;
+    size_t next = 0;
+
+    for (const char* p = format; *p; p++) {
+        if (p[0] == '{' && p[1] == '}') {
+            message += (next < args.size()) ? args[next++] : "?";
+            p++;
+        } else {
+            message += *p;
+        }
+    }
+    return message;
+}
+
+static string formatTimestamp(uint64_t timestampNs) {
+    time_t seconds = static_cast<time_t>(timestampNs / 1000000000ULL);
+    unsigned micros = static_cast<unsigned>((timestampNs % 1000000000ULL) / 1000);
+
+    char buffer[32];
+    strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M:%S", gmtime(&seconds));
+
+    char result[48];
+    snprintf(result, sizeof(result), "%s.%06u", buffer, micros);
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 2) {
+        cerr << "Usage: " << argv[0] << " <log file>" << endl;
+        return 1;
+    }
+
+    FILE* file = fopen(argv[1], "rb");
+    if (file == nullptr) {
+        cerr << "Cannot open " << argv[1] << endl;
+        return 1;
+    }
+
+    LogFileHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 ||
+        memcmp(header.magic, LOG_FILE_MAGIC, sizeof(header.magic)) != 0 ||
+        header.recordSize != sizeof(LogRecord)) {
+        cerr << "Not a RideShare binary log: " << argv[1] << endl;
+        fclose(file);
+        return 1;
+    }
+
+    vector<LogRecord> records;
+    LogRecord record;
+    while (fread(&record, sizeof(record), 1, file) == 1) {
+        records.push_back(record);
+    }
+    fclose(file);
+
+    // Each thread's ring is flushed independently, so restore global order here
+    stable_sort(records.begin(), records.end(),
+        [](const LogRecord& a, const LogRecord& b) {
+            return a.timestampNs < b.timestampNs;
+        });
+
+    for (const auto& r : records) {
+        const LogEventSchema& schema = getEventSchema(static_cast<LogEvent>(r.eventId));
+        cout << formatTimestamp(r.timestampNs)
+             << " [" << getLogLevelString(static_cast<LogLevel>(r.level)) << "]"
+             << " [T" << r.threadIndex << "] "
+             << schema.name << ": " << formatMessage(schema.format, decodeArgs(r)) << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,153 @@
+// Concurrency check for the hot-swappable dispatch config (concurrency/rcu_cell.h,
+// config/dispatch_config.h). Reader threads pin snapshots, hold them across
+// yields and dereference the strategy and pricing chain while a writer
+// publishes new versions and a housekeeping thread reclaims retired ones.
+// Readers fail the run if a snapshot changes under them or versions go
+// backwards; the end state must have every retired config freed. Meant to run
+// under ThreadSanitizer (and AddressSanitizer, to catch a config freed while
+// still pinned):
+//   g++ -std=c++14 -O1 -g -fsanitize=thread -I. tools/rcu_stress.cpp -o rcu_stress -pthread
+// Usage: rcu_stress [readers] [publishes]
+
+#include "managers/ride_manager.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+// Pricing component that records which config it belongs to and is scrubbed
+// on destruction, so a reader that outlives its snapshot sees a mismatch
+class StampedFareCalculator : public BaseFareCalculator {
+private:
+    atomic<uint64_t> stamp;
+
+public:
+    static atomic<long> liveCount;
+
+    explicit StampedFareCalculator(uint64_t version) : stamp(version) { liveCount++; }
+    ~StampedFareCalculator() override {
+        stamp.store(0, memory_order_relaxed);
+        liveCount--;
+    }
+
+    uint64_t getStamp() const { return stamp.load(memory_order_relaxed); }
+};
+
+atomic<long> StampedFareCalculator::liveCount(0);
+
+struct ReaderResult {
+    uint64_t reads = 0;
+    uint64_t errors = 0;
+};
+
+static void readSnapshots(const RcuCell<DispatchConfig>& cell, const atomic<bool>& stop,
+                          atomic<unsigned>& ready, ReaderResult& result) {
+    Location pickup(19.0760, 72.8777);
+    Location dropoff(19.0896, 72.8656);
+    Ride ride("STRESS", nullptr, pickup, dropoff, VehicleType::SEDAN);
+    uint64_t lastVersion = 0;
+    ready++;
+
+    while (!stop.load(memory_order_relaxed)) {
+        auto config = cell.read();
+        uint64_t version = config->version;
+        auto* calculator = static_cast<StampedFareCalculator*>(config->fareCalculator.get());
+
+        if (version < lastVersion) result.errors++;
+        lastVersion = version;
+        if (calculator->getStamp() != version) result.errors++;
+
+        // Hold the snapshot while the writer moves on, then use it again
+        this_thread::yield();
+        {
+            auto nested = cell.read();
+            if (nested->version < version) result.errors++;
+        }
+        if (config->matchingStrategy->getStrategyName().empty()) result.errors++;
+        if (!(calculator->calculateFare(ride) > 0.0)) result.errors++;
+        if (calculator->getStamp() != version || config->version != version) result.errors++;
+        result.reads++;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    unsigned readerCount = (argc > 1) ? static_cast<unsigned>(atoi(argv[1])) : 4;
+    uint64_t publishes = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 20000;
+
+    auto strategy = make_shared<NearestDriverStrategy>();
+    RcuCell<DispatchConfig> cell(make_unique<DispatchConfig>(
+        strategy, make_shared<StampedFareCalculator>(1), 1));
+
+    atomic<bool> stopReaders(false);
+    atomic<bool> stopHousekeeping(false);
+    atomic<unsigned> readersReady(0);
+    vector<ReaderResult> results(readerCount);
+    vector<thread> readers;
+    for (unsigned i = 0; i < readerCount; i++) {
+        readers.emplace_back(readSnapshots, cref(cell), cref(stopReaders), ref(readersReady),
+                             ref(results[i]));
+    }
+    while (readersReady.load() < readerCount) this_thread::yield();
+
+    // Stands in for the ride server loop's reclaimRetiredConfigs() tick
+    atomic<uint64_t> reclaimedByHousekeeping(0);
+    thread housekeeping([&]() {
+        while (!stopHousekeeping.load(memory_order_relaxed)) {
+            reclaimedByHousekeeping += cell.reclaim();
+            this_thread::yield();
+        }
+    });
+
+    for (uint64_t version = 2; version <= publishes + 1; version++) {
+        cell.publish(make_unique<DispatchConfig>(
+            strategy, make_shared<StampedFareCalculator>(version), version));
+        this_thread::yield();   // let readers pin versions in between
+    }
+
+    stopReaders = true;
+    for (auto& reader : readers) reader.join();
+    stopHousekeeping = true;
+    housekeeping.join();
+
+    // No reader is left, so everything retired must be reclaimable now
+    cell.reclaim();
+
+    // The case reclaim() exists for: a reader still holds the version replaced
+    // by the last publish, so only a later reclaim can free it
+    uint64_t finalVersion = publishes + 2;
+    bool heldVersionKept;
+    {
+        auto held = cell.read();
+        cell.publish(make_unique<DispatchConfig>(
+            strategy, make_shared<StampedFareCalculator>(finalVersion), finalVersion));
+        auto* calculator = static_cast<const StampedFareCalculator*>(held->fareCalculator.get());
+        heldVersionKept = cell.getPendingReclaimCount() == 1 && calculator->getStamp() == held->version;
+    }
+    size_t reclaimedAfterRelease = cell.reclaim();
+
+    uint64_t reads = 0;
+    uint64_t errors = 0;
+    for (const auto& result : results) {
+        reads += result.reads;
+        errors += result.errors;
+    }
+    size_t pending = cell.getPendingReclaimCount();
+    long live = StampedFareCalculator::liveCount.load();
+
+    cout << "Readers: " << readerCount << ", snapshot reads: " << reads
+         << ", publishes: " << publishes + 1 << ", final version: " << cell.getVersion() << endl;
+    cout << "Reclaimed by housekeeping: " << reclaimedByHousekeeping.load()
+         << ", freed after the last pinned reader left: " << reclaimedAfterRelease
+         << ", still retired: " << pending << ", live configs: " << live << endl;
+
+    if (errors != 0 || pending != 0 || live != 1 || cell.getVersion() != finalVersion ||
+        !heldVersionKept || reclaimedAfterRelease != 1) {
+        cout << "FAILED (" << errors << " inconsistent reads)" << endl;
+        return 1;
+    }
+    cout << "PASSED" << endl;
+    return 0;
+}
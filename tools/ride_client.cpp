@@ -0,0 +1,54 @@
+// Drives one ride through a running ride_server: quote, request, start, complete.
+// Usage: ride_client [host] [port] [rider id]
+
+#include "network/ride_client.h"
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+
+using namespace std;
+
+static bool report(const char* step, bool sent, const RideResponse& response) {
+    if (!sent) {
+        cout << step << ": connection lost" << endl;
+        return false;
+    }
+    cout << setw(14) << left << step << responseStatusString(response.status);
+    if (response.status == ResponseStatus::REJECTED) {
+        cout << "  (" << ServiceCheck(response.rejection).getDecisionString() << ")";
+    }
+    if (!response.rideId.empty()) cout << "  ride " << response.rideId << " driver " << response.driverId;
+    if (response.fare > 0.0) cout << "  fare Rs. " << fixed << setprecision(2) << response.fare;
+    if (response.distanceKm > 0.0) cout << "  (" << setprecision(2) << response.distanceKm << " km)";
+    cout << endl;
+    return response.isOk();
+}
+
+int main(int argc, char* argv[]) {
+    string host = (argc > 1) ? argv[1] : "127.0.0.1";
+    uint16_t port = static_cast<uint16_t>((argc > 2) ? atoi(argv[2]) : 7070);
+    string riderId = (argc > 3) ? argv[3] : "R0";
+
+    RideClient client;
+    if (!client.connect(host, port)) {
+        cerr << "Cannot connect to " << host << ":" << port << endl;
+        return 1;
+    }
+
+    Location pickup(19.0760, 72.8777);
+    Location dropoff(19.0896, 72.8656);
+    RideResponse response;
+
+    if (!report("Quote", client.quote(pickup, dropoff, VehicleType::SEDAN, response), response)) {
+        return 1;
+    }
+    if (!report("Request ride", client.requestRide(riderId, pickup, dropoff, VehicleType::SEDAN,
+                                                    response), response)) {
+        return 1;
+    }
+
+    string rideId = response.rideId;
+    if (!report("Start ride", client.startRide(rideId, response), response)) return 1;
+    if (!report("Complete ride", client.completeRide(rideId, response), response)) return 1;
+    return 0;
+}
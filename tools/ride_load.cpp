@@ -0,0 +1,385 @@
+// Load generator for ride_server. Opens many connections, keeps 'pipeline'
+// requests in flight on each, and reports throughput and latency percentiles.
+// In "ride" mode every in-flight slot loops request -> start -> driver location
+// -> complete using the ride and driver ids from the previous responses;
+// "quote" mode only sends fare quotes.
+// Usage: ride_load [host] [port] [connections] [pipeline] [seconds] [quote|ride]
+//                  [riders] [threads]
+
+#include "network/ride_client.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <thread>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/resource.h>
+
+using namespace std;
+
+struct LoadOptions {
+    string host;
+    uint16_t port;
+    size_t connections;
+    size_t pipeline;
+    int seconds;
+    bool rideMode;
+    size_t riders;
+    unsigned threads;
+};
+
+struct WorkerResult {
+    vector<uint32_t> latencyUs;
+    uint64_t statusCounts[RESPONSE_STATUS_COUNT];
+    size_t connected;
+    size_t failedConnections;
+
+    WorkerResult() : connected(0), failedConnections(0) {
+        fill(begin(statusCounts), end(statusCounts), 0);
+    }
+};
+
+class LoadWorker {
+private:
+    struct Outstanding {
+        chrono::steady_clock::time_point sentAt;
+        string rideId;      // ride a START/COMPLETE refers to
+        string driverId;    // driver assigned to that ride
+    };
+
+    struct LoadConnection {
+        int fd;
+        vector<uint8_t> input;
+        vector<uint8_t> output;
+        size_t outputStart;
+        bool writeInterest;
+        deque<Outstanding> inFlight;
+
+        LoadConnection() : fd(-1), outputStart(0), writeInterest(false) {}
+    };
+
+    const LoadOptions& options;
+    int epollFd;
+    vector<LoadConnection> connections;
+    mt19937 rng;
+    uint32_t nextRequestId;
+    WorkerResult& result;
+
+    Location randomLocation() {
+        uniform_real_distribution<double> lat(18.90, 19.30);
+        uniform_real_distribution<double> lng(72.77, 73.05);
+        double a = lat(rng);
+        return Location(a, lng(rng));
+    }
+
+    void enqueue(LoadConnection& connection, MessageType type, const string& rideId,
+                 const string& driverId) {
+        uint32_t id = nextRequestId++;
+        switch (type) {
+            case MessageType::REQUEST_RIDE:
+                RideRequestEncoder::requestRide(connection.output, id,
+                    "R" + to_string(rng() % options.riders), randomLocation(), randomLocation(),
+                    static_cast<VehicleType>(rng() % VEHICLE_TYPE_COUNT));
+                break;
+            case MessageType::START_RIDE:
+                RideRequestEncoder::startRide(connection.output, id, rideId);
+                break;
+            case MessageType::COMPLETE_RIDE:
+                RideRequestEncoder::completeRide(connection.output, id, rideId);
+                break;
+            case MessageType::QUOTE:
+                RideRequestEncoder::quote(connection.output, id, randomLocation(), randomLocation(),
+                                          static_cast<VehicleType>(rng() % VEHICLE_TYPE_COUNT));
+                break;
+            case MessageType::DRIVER_LOCATION:
+                RideRequestEncoder::driverLocation(connection.output, id, driverId, randomLocation());
+                break;
+        }
+        Outstanding entry;
+        entry.sentAt = chrono::steady_clock::now();
+        entry.rideId = rideId;
+        entry.driverId = driverId;
+        connection.inFlight.push_back(entry);
+    }
+
+    void enqueueFresh(LoadConnection& connection) {
+        enqueue(connection, options.rideMode ? MessageType::REQUEST_RIDE : MessageType::QUOTE, "", "");
+    }
+
+    // Next step of this slot's lifecycle after 'response'
+    void enqueueNext(LoadConnection& connection, const RideResponse& response,
+                     const Outstanding& done) {
+        if (response.isOk() && response.type == MessageType::REQUEST_RIDE) {
+            enqueue(connection, MessageType::START_RIDE, response.rideId, response.driverId);
+        } else if (response.isOk() && response.type == MessageType::START_RIDE) {
+            enqueue(connection, MessageType::DRIVER_LOCATION, done.rideId, done.driverId);
+        } else if (response.type == MessageType::DRIVER_LOCATION) {
+            enqueue(connection, MessageType::COMPLETE_RIDE, done.rideId, done.driverId);
+        } else {
+            enqueueFresh(connection);
+        }
+    }
+
+    void setWriteInterest(LoadConnection& connection, bool wantWrite) {
+        if (connection.writeInterest == wantWrite) return;
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        if (wantWrite) ev.events |= EPOLLOUT;
+        ev.data.u32 = static_cast<uint32_t>(&connection - connections.data());
+        epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &ev);
+        connection.writeInterest = wantWrite;
+    }
+
+    bool flush(LoadConnection& connection) {
+        while (connection.outputStart < connection.output.size()) {
+            ssize_t n = send(connection.fd, connection.output.data() + connection.outputStart,
+                             connection.output.size() - connection.outputStart, MSG_NOSIGNAL);
+            if (n > 0) {
+                connection.outputStart += static_cast<size_t>(n);
+            } else if (n < 0 && errno == EINTR) {
+                continue;
+            } else {
+                if (n < 0 && errno != EAGAIN && errno != EWOULDBLOCK) return false;
+                break;
+            }
+        }
+        if (connection.outputStart == connection.output.size()) {
+            connection.output.clear();
+            connection.outputStart = 0;
+        }
+        setWriteInterest(connection, connection.outputStart < connection.output.size());
+        return true;
+    }
+
+    void closeConnection(LoadConnection& connection) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        close(connection.fd);
+        connection.fd = -1;
+        connection.inFlight.clear();
+    }
+
+    // Reads responses, records their latency and, while 'refill', replaces
+    // each with the next request of its slot
+    void readResponses(LoadConnection& connection, bool record, bool refill) {
+        uint8_t chunk[16384];
+        for (;;) {
+            ssize_t n = recv(connection.fd, chunk, sizeof(chunk), 0);
+            if (n > 0) {
+                connection.input.insert(connection.input.end(), chunk, chunk + n);
+                continue;
+            }
+            if (n < 0 && errno == EINTR) continue;
+            if (n == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                closeConnection(connection);
+                return;
+            }
+            break;
+        }
+
+        auto now = chrono::steady_clock::now();
+        size_t offset = 0;
+        RideResponse response;
+        for (;;) {
+            size_t frameSize = completeFrameSize(connection.input.data() + offset,
+                                                 connection.input.size() - offset);
+            if (frameSize == 0) break;
+            if (frameSize == SIZE_MAX || connection.inFlight.empty() ||
+                !response.decode(connection.input.data() + offset, frameSize)) {
+                closeConnection(connection);
+                return;
+            }
+            offset += frameSize;
+
+            Outstanding done = move(connection.inFlight.front());
+            connection.inFlight.pop_front();
+            if (record) {
+                auto latency = chrono::duration_cast<chrono::microseconds>(now - done.sentAt);
+                result.latencyUs.push_back(static_cast<uint32_t>(latency.count()));
+                result.statusCounts[static_cast<size_t>(response.status) % RESPONSE_STATUS_COUNT]++;
+            }
+            if (refill) enqueueNext(connection, response, done);
+        }
+        connection.input.erase(connection.input.begin(), connection.input.begin() + offset);
+
+        if (!flush(connection)) closeConnection(connection);
+    }
+
+    bool connectOne(LoadConnection& connection, const sockaddr_in& addr) {
+        int fd = socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0) return false;
+        if (connect(fd, reinterpret_cast<const sockaddr*>(&addr), sizeof(addr)) != 0) {
+            close(fd);
+            return false;
+        }
+        int one = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        int flags = fcntl(fd, F_GETFL, 0);
+        fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+
+        connection.fd = fd;
+        epoll_event ev;
+        ev.events = EPOLLIN;
+        ev.data.u32 = static_cast<uint32_t>(&connection - connections.data());
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+        return true;
+    }
+
+public:
+    LoadWorker(const LoadOptions& opts, size_t count, unsigned seed, WorkerResult& out)
+        : options(opts), epollFd(epoll_create1(EPOLL_CLOEXEC)),
+          connections(count), rng(seed), nextRequestId(1), result(out) {}
+
+    ~LoadWorker() {
+        for (auto& connection : connections) {
+            if (connection.fd >= 0) close(connection.fd);
+        }
+        close(epollFd);
+    }
+
+    bool connectAll() {
+        sockaddr_in addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(options.port);
+        if (inet_pton(AF_INET, options.host.c_str(), &addr.sin_addr) != 1) return false;
+
+        for (auto& connection : connections) {
+            if (connectOne(connection, addr)) {
+                result.connected++;
+            } else {
+                result.failedConnections++;
+            }
+        }
+        return result.connected > 0;
+    }
+
+    // Runs until 'measureUntil', recording only responses after 'measureFrom',
+    // then drains what is still in flight
+    void run(chrono::steady_clock::time_point measureFrom,
+             chrono::steady_clock::time_point measureUntil) {
+        for (auto& connection : connections) {
+            if (connection.fd < 0) continue;
+            for (size_t i = 0; i < options.pipeline; i++) enqueueFresh(connection);
+            if (!flush(connection)) closeConnection(connection);
+        }
+
+        vector<epoll_event> events(1024);
+        auto drainDeadline = measureUntil + chrono::seconds(5);
+        for (;;) {
+            auto now = chrono::steady_clock::now();
+            bool refill = now < measureUntil;
+            if (!refill) {
+                size_t pending = 0;
+                for (const auto& connection : connections) pending += connection.inFlight.size();
+                if (pending == 0 || now > drainDeadline) break;
+            }
+
+            int ready = epoll_wait(epollFd, events.data(), static_cast<int>(events.size()), 10);
+            now = chrono::steady_clock::now();
+            bool record = now >= measureFrom && now < measureUntil;
+            for (int i = 0; i < ready; i++) {
+                LoadConnection& connection = connections[events[i].data.u32];
+                if (connection.fd < 0) continue;
+                if (events[i].events & EPOLLOUT) {
+                    if (!flush(connection)) {
+                        closeConnection(connection);
+                        continue;
+                    }
+                }
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    readResponses(connection, record, refill);
+                }
+            }
+        }
+    }
+};
+
+static void raiseFileLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+}
+
+static uint32_t percentile(const vector<uint32_t>& sorted, double p) {
+    if (sorted.empty()) return 0;
+    size_t index = static_cast<size_t>(p * (sorted.size() - 1));
+    return sorted[index];
+}
+
+int main(int argc, char* argv[]) {
+    LoadOptions options;
+    options.host = (argc > 1) ? argv[1] : "127.0.0.1";
+    options.port = static_cast<uint16_t>((argc > 2) ? atoi(argv[2]) : 7070);
+    options.connections = (argc > 3) ? strtoull(argv[3], nullptr, 10) : 10000;
+    options.pipeline = (argc > 4) ? strtoull(argv[4], nullptr, 10) : 4;
+    options.seconds = (argc > 5) ? atoi(argv[5]) : 10;
+    options.rideMode = (argc > 6) && string(argv[6]) == "ride";
+    options.riders = max<size_t>(1, (argc > 7) ? strtoull(argv[7], nullptr, 10) : 1000);
+    options.threads = (argc > 8) ? static_cast<unsigned>(atoi(argv[8]))
+                                 : min(4u, max(1u, thread::hardware_concurrency()));
+    options.threads = max(1u, options.threads);
+
+    raiseFileLimit();
+
+    vector<WorkerResult> results(options.threads);
+    vector<unique_ptr<LoadWorker>> workers;
+    size_t connected = 0;
+    size_t failed = 0;
+    for (unsigned t = 0; t < options.threads; t++) {
+        size_t share = options.connections / options.threads +
+                       (t < options.connections % options.threads ? 1 : 0);
+        workers.emplace_back(new LoadWorker(options, share, 1234 + t, results[t]));
+        workers.back()->connectAll();
+        connected += results[t].connected;
+        failed += results[t].failedConnections;
+    }
+
+    cout << "Connected " << connected << "/" << options.connections << " ("
+         << failed << " failed), pipeline " << options.pipeline << ", "
+         << (options.rideMode ? "ride lifecycle" : "quote") << " mode, "
+         << options.threads << " threads, " << options.seconds << "s" << endl;
+    if (connected == 0) return 1;
+
+    // The first second warms up the pipelines and is not measured
+    auto measureFrom = chrono::steady_clock::now() + chrono::seconds(1);
+    auto measureUntil = measureFrom + chrono::seconds(options.seconds);
+
+    vector<thread> pool;
+    for (auto& worker : workers) {
+        LoadWorker* w = worker.get();
+        pool.emplace_back([w, measureFrom, measureUntil]() { w->run(measureFrom, measureUntil); });
+    }
+    for (auto& t : pool) t.join();
+
+    vector<uint32_t> latencies;
+    uint64_t statusCounts[RESPONSE_STATUS_COUNT] = {};
+    for (auto& r : results) {
+        latencies.insert(latencies.end(), r.latencyUs.begin(), r.latencyUs.end());
+        for (size_t s = 0; s < RESPONSE_STATUS_COUNT; s++) statusCounts[s] += r.statusCounts[s];
+    }
+    sort(latencies.begin(), latencies.end());
+
+    cout << fixed << setprecision(0);
+    cout << "Requests: " << latencies.size() << "  ("
+         << latencies.size() / static_cast<double>(options.seconds) << " req/s)" << endl;
+    cout << "Latency us: p50 " << percentile(latencies, 0.50)
+         << "  p90 " << percentile(latencies, 0.90)
+         << "  p99 " << percentile(latencies, 0.99)
+         << "  p99.9 " << percentile(latencies, 0.999)
+         << "  max " << (latencies.empty() ? 0 : latencies.back()) << endl;
+    cout << "Status:";
+    for (size_t s = 0; s < RESPONSE_STATUS_COUNT; s++) {
+        if (statusCounts[s]) {
+            cout << " " << responseStatusString(static_cast<ResponseStatus>(s)) << "=" << statusCounts[s];
+        }
+    }
+    cout << endl;
+    return 0;
+}
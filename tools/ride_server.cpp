@@ -0,0 +1,100 @@
+// Standalone TCP front end for RideManager (network/ride_server.h) with a
+// synthetic fleet of drivers and riders spread over Mumbai.
+// Usage: ride_server [port] [drivers] [riders] [ride capacity] [zones file]
+
+#include "network/ride_server.h"
+#include "factories/vehicle_factory.h"
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <sys/resource.h>
+
+static RideServer* activeServer = nullptr;
+
+static void handleSignal(int) {
+    if (activeServer) activeServer->stop();
+}
+
+// Lifts the open-file limit to the hard maximum so 10k+ clients can connect
+static rlim_t raiseFileLimit() {
+    rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) != 0) return 0;
+    limit.rlim_cur = limit.rlim_max;
+    setrlimit(RLIMIT_NOFILE, &limit);
+    getrlimit(RLIMIT_NOFILE, &limit);
+    return limit.rlim_cur;
+}
+
+int main(int argc, char* argv[]) {
+    uint16_t port = static_cast<uint16_t>((argc > 1) ? atoi(argv[1]) : 7070);
+    size_t driverCount = (argc > 2) ? strtoull(argv[2], nullptr, 10) : 2000;
+    size_t riderCount = (argc > 3) ? strtoull(argv[3], nullptr, 10) : 1000;
+    size_t rideCapacity = (argc > 4) ? strtoull(argv[4], nullptr, 10) : 200000;
+
+    RideManager* rideManager = RideManager::getInstance();
+    unique_ptr<FareCalculator> fareCalculator = make_unique<SurgePricingDecorator>(
+        make_unique<BaseFareCalculator>(), 1.2);
+
+    // Optional service areas and special-fare zones (e.g. geofence/mumbai_zones.txt)
+    if (argc > 5) {
+        auto zones = make_shared<GeofenceIndex>();
+        string error;
+        if (!zones->loadFile(argv[5], error)) {
+            cerr << "Cannot load zones: " << error << endl;
+            return 1;
+        }
+        rideManager->setGeofence(zones);
+        fareCalculator = make_unique<ZoneSurchargeDecorator>(move(fareCalculator), zones);
+        cout << "Loaded " << zones->getZoneCount() << " zones from " << argv[5] << endl;
+    }
+    rideManager->setFareCalculator(move(fareCalculator));
+
+    mt19937 rng(42);
+    uniform_real_distribution<double> lat(18.90, 19.30);
+    uniform_real_distribution<double> lng(72.77, 73.05);
+    const VehicleType types[] = {VehicleType::BIKE, VehicleType::SEDAN,
+                                 VehicleType::SUV, VehicleType::AUTO_RICKSHAW};
+
+    for (size_t i = 0; i < driverCount; i++) {
+        string id = "D" + to_string(i);
+        rideManager->addDriver(make_shared<Driver>(id, "Driver " + to_string(i), "9000000000",
+            Location(lat(rng), lng(rng)),
+            VehicleFactory::createVehicle(types[i % 4], "V" + to_string(i), "MH01" + to_string(i)),
+            4.5));
+    }
+    for (size_t i = 0; i < riderCount; i++) {
+        rideManager->addRider(make_shared<Rider>("R" + to_string(i), "Rider " + to_string(i),
+            "9100000000", Location(lat(rng), lng(rng)), 4.5));
+    }
+    // Half the reserved capacity holds finished rides, the rest active ones;
+    // older finished rides are evicted so a long run stops allocating
+    rideManager->setRetentionPolicy(RideRetentionPolicy(rideCapacity / 2, 100));
+    rideManager->reserveRideCapacity(rideCapacity);
+
+    RideServer server(*rideManager);
+    if (!server.listen("0.0.0.0", port)) {
+        perror("listen");
+        return 1;
+    }
+
+    activeServer = &server;
+    signal(SIGINT, handleSignal);
+    signal(SIGTERM, handleSignal);
+
+    cout << "Ride server on port " << port << " with " << driverCount << " drivers, "
+         << riderCount << " riders (R0..R" << (riderCount ? riderCount - 1 : 0)
+         << "), fd limit " << raiseFileLimit() << endl;
+
+    server.run();
+    activeServer = nullptr;
+
+    const RideServerStats& stats = server.getStats();
+    cout << "Connections accepted: " << stats.acceptedConnections
+         << ", protocol errors: " << stats.protocolErrors << endl;
+    cout << "Requests: " << stats.requests << " in " << stats.batches << " batches (avg "
+         << (stats.batches ? stats.requests / stats.batches : 0) << ", largest "
+         << stats.largestBatch << ")" << endl;
+    cout << "Rides tracked: " << rideManager->getRides().size() << endl;
+    return 0;
+}
@@ -0,0 +1,232 @@
+#ifndef GPS_TRACE_H
+#define GPS_TRACE_H
+
+#include "../common/types.h"
+#include "../common/pool_allocator.h"
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+
+// Fixed-point scale for stored coordinates (1e-5 degrees, about 1 m)
+const double TRACE_COORDINATE_SCALE = 1e5;
+
+struct TracePoint {
+    double latitude;
+    double longitude;
+    int64_t timeMs;     // system_clock milliseconds since epoch
+};
+
+// Fixed-size block of encoded trace bytes; chunks of a trace form a singly
+// linked list and come from a block pool
+struct TraceChunk {
+    static const size_t CAPACITY = 246;
+
+    TraceChunk* next;
+    uint16_t used;
+    uint8_t bytes[CAPACITY];
+
+    TraceChunk() : next(nullptr), used(0) {}
+};
+
+static_assert(sizeof(TraceChunk) == 256, "TraceChunk should fill a 256-byte block");
+
+inline double haversineKm(double lat1, double lng1, double lat2, double lng2) {
+    const double earthRadiusKm = 6371.0;
+    const double toRadians = M_PI / 180.0;
+    double dLat = (lat2 - lat1) * toRadians;
+    double dLng = (lng2 - lng1) * toRadians;
+    double a = sin(dLat / 2) * sin(dLat / 2) +
+               cos(lat1 * toRadians) * cos(lat2 * toRadians) * sin(dLng / 2) * sin(dLng / 2);
+    return 2.0 * earthRadiusKm * asin(min(1.0, sqrt(a)));
+}
+
+// Streams points back out of a trace, one varint at a time across chunk
+// boundaries; never materializes the whole trace
+class TraceCursor {
+private:
+    const TraceChunk* chunk;
+    size_t offset;
+    size_t remaining;
+    int64_t lat;
+    int64_t lng;
+    int64_t timeMs;
+
+    uint8_t nextByte() {
+        while (offset >= chunk->used) {
+            chunk = chunk->next;
+            offset = 0;
+        }
+        return chunk->bytes[offset++];
+    }
+
+    int64_t nextDelta() {
+        uint64_t value = 0;
+        int shift = 0;
+        uint8_t byte;
+        do {
+            byte = nextByte();
+            value |= static_cast<uint64_t>(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+public:
+    TraceCursor(const TraceChunk* head, size_t points)
+        : chunk(head), offset(0), remaining(points), lat(0), lng(0), timeMs(0) {}
+
+    bool next(TracePoint& point) {
+        if (remaining == 0) return false;
+        remaining--;
+        lat += nextDelta();
+        lng += nextDelta();
+        timeMs += nextDelta();
+        point.latitude = lat / TRACE_COORDINATE_SCALE;
+        point.longitude = lng / TRACE_COORDINATE_SCALE;
+        point.timeMs = timeMs;
+        return true;
+    }
+};
+
+// Route actually driven during a ride. Points are quantized to
+// TRACE_COORDINATE_SCALE (the same precision as encoded polylines) and stored as
+// zigzag-varint deltas from the previous point, so a typical 1 Hz fix costs
+// 4-5 bytes instead of 24. Bytes go into pooled 256-byte chunks appended as
+// the trace grows; the path length is accumulated on append.
+class GpsTrace {
+private:
+    static const size_t MAX_POINT_BYTES = 30;   // three 64-bit varints, 10 bytes each
+
+    TraceChunk* head;
+    TraceChunk* tail;
+    size_t pointCount;
+    size_t chunkCount;
+    size_t encodedBytes;
+    int64_t lastLat;
+    int64_t lastLng;
+    int64_t lastTimeMs;
+    double pathLengthKm;
+
+    static uint8_t* putDelta(uint8_t* out, int64_t delta) {
+        uint64_t value = (static_cast<uint64_t>(delta) << 1) ^ static_cast<uint64_t>(delta >> 63);
+        while (value >= 0x80) {
+            *out++ = static_cast<uint8_t>(value | 0x80);
+            value >>= 7;
+        }
+        *out++ = static_cast<uint8_t>(value);
+        return out;
+    }
+
+    void appendBytes(const uint8_t* data, size_t length) {
+        while (length > 0) {
+            if (!tail || tail->used == TraceChunk::CAPACITY) {
+                TraceChunk* chunk = new (PoolAllocator<TraceChunk>().allocate(1)) TraceChunk();
+                if (tail) tail->next = chunk;
+                else head = chunk;
+                tail = chunk;
+                chunkCount++;
+            }
+            size_t room = TraceChunk::CAPACITY - tail->used;
+            size_t n = length < room ? length : room;
+            memcpy(tail->bytes + tail->used, data, n);
+            tail->used = static_cast<uint16_t>(tail->used + n);
+            data += n;
+            length -= n;
+        }
+    }
+
+public:
+    GpsTrace()
+        : head(nullptr), tail(nullptr), pointCount(0), chunkCount(0), encodedBytes(0),
+          lastLat(0), lastLng(0), lastTimeMs(0), pathLengthKm(0.0) {}
+
+    ~GpsTrace() { clear(); }
+
+    GpsTrace(const GpsTrace&) = delete;
+    GpsTrace& operator=(const GpsTrace&) = delete;
+
+    // Coordinates must be finite and in range (see Location::hasValidCoordinates);
+    // the quantized values would otherwise overflow int64_t
+    void append(double latitude, double longitude, int64_t timeMs) {
+        int64_t lat = llround(latitude * TRACE_COORDINATE_SCALE);
+        int64_t lng = llround(longitude * TRACE_COORDINATE_SCALE);
+
+        if (pointCount > 0) {
+            const double scale = TRACE_COORDINATE_SCALE;
+            pathLengthKm += haversineKm(lastLat / scale, lastLng / scale, lat / scale, lng / scale);
+        }
+
+        uint8_t encoded[MAX_POINT_BYTES];
+        uint8_t* end = putDelta(encoded, lat - lastLat);
+        end = putDelta(end, lng - lastLng);
+        end = putDelta(end, timeMs - lastTimeMs);
+        size_t length = static_cast<size_t>(end - encoded);
+        appendBytes(encoded, length);
+        encodedBytes += length;
+
+        lastLat = lat;
+        lastLng = lng;
+        lastTimeMs = timeMs;
+        pointCount++;
+    }
+
+    void append(const Location& location, chrono::system_clock::time_point time) {
+        append(location.latitude, location.longitude,
+               chrono::duration_cast<chrono::milliseconds>(time.time_since_epoch()).count());
+    }
+
+    // Returns every chunk to the pool
+    void clear() {
+        while (head) {
+            TraceChunk* next = head->next;
+            head->~TraceChunk();
+            PoolAllocator<TraceChunk>().deallocate(head, 1);
+            head = next;
+        }
+        tail = nullptr;
+        pointCount = 0;
+        chunkCount = 0;
+        encodedBytes = 0;
+        lastLat = 0;
+        lastLng = 0;
+        lastTimeMs = 0;
+        pathLengthKm = 0.0;
+    }
+
+    TraceCursor cursor() const { return TraceCursor(head, pointCount); }
+
+    template <typename Visitor>
+    void forEachPoint(Visitor visit) const {
+        TraceCursor points = cursor();
+        TracePoint point;
+        while (points.next(point)) visit(point);
+    }
+
+    // Recomputes the path length from the encoded points, e.g. for audits
+    double computePathLengthKm() const {
+        double length = 0.0;
+        bool first = true;
+        TracePoint previous = TracePoint();
+        forEachPoint([&](const TracePoint& point) {
+            if (!first) {
+                length += haversineKm(previous.latitude, previous.longitude,
+                                      point.latitude, point.longitude);
+            }
+            previous = point;
+            first = false;
+        });
+        return length;
+    }
+
+    size_t getPointCount() const { return pointCount; }
+    bool isEmpty() const { return pointCount == 0; }
+    double getPathLengthKm() const { return pathLengthKm; }
+    size_t getEncodedBytes() const { return encodedBytes; }
+    size_t getAllocatedBytes() const { return chunkCount * sizeof(TraceChunk); }
+    double getBytesPerPoint() const {
+        return pointCount ? static_cast<double>(encodedBytes) / pointCount : 0.0;
+    }
+};
+
+#endif
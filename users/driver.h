@@ -3,6 +3,7 @@
 
 #include "user.h"
 #include "../vehicles/vehicle.h"
+#include <vector>
 
 class Driver : public User {
 private:
@@ -10,6 +11,7 @@ private:
     DriverStatus status;
     unique_ptr<Vehicle> vehicle;
     vector<string> rideHistory;
+    string currentRideId;   // ride the driver is assigned to, empty when free
 
 public:
     Driver(const string& id, const string& name, const string& phone,
@@ -27,7 +29,17 @@ public:
     
     bool isAvailable() const { return status == DriverStatus::AVAILABLE; }
     
-    void addRideToHistory(const string& rideId) {
+    const string& getCurrentRideId() const { return currentRideId; }
+    void setCurrentRideId(const string& rideId) { currentRideId = rideId; }
+    void clearCurrentRideId() { currentRideId.clear(); }
+    
+    void reserveRideHistory(size_t rides) { rideHistory.reserve(rides); }
+    
+    // With a limit, the oldest entry makes room, so a reserved history never grows
+    void addRideToHistory(const string& rideId, size_t limit = 0) {
+        if (limit > 0 && rideHistory.size() >= limit) {
+            rideHistory.erase(rideHistory.begin(), rideHistory.end() - (limit - 1));
+        }
         rideHistory.push_back(rideId);
     }
     
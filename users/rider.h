@@ -17,7 +17,13 @@ public:
     double getRating() const { return rating; }
     void setRating(double r) { rating = r; }
     
-    void addRideToHistory(const string& rideId) {
+    void reserveRideHistory(size_t rides) { rideHistory.reserve(rides); }
+    
+    // With a limit, the oldest entry makes room, so a reserved history never grows
+    void addRideToHistory(const string& rideId, size_t limit = 0) {
+        if (limit > 0 && rideHistory.size() >= limit) {
+            rideHistory.erase(rideHistory.begin(), rideHistory.end() - (limit - 1));
+        }
         rideHistory.push_back(rideId);
     }
     
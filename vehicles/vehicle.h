@@ -25,12 +25,23 @@ public:
     double getBaseFareRate() const { return baseFareRate; }
     
     virtual string getTypeString() const = 0;
+    
+    // Per-km rate for each vehicle type, also used to price rides with no driver yet
+    static double getDefaultFareRate(VehicleType t) {
+        switch (t) {
+            case VehicleType::BIKE: return 8.0;
+            case VehicleType::SEDAN: return 12.0;
+            case VehicleType::SUV: return 18.0;
+            case VehicleType::AUTO_RICKSHAW: return 6.0;
+            default: return 10.0;
+        }
+    }
 };
 
 class Bike : public Vehicle {
 public:
     Bike(const string& id, const string& plate)
-        : Vehicle(id, plate, VehicleType::BIKE, 1, 8.0) {}
+        : Vehicle(id, plate, VehicleType::BIKE, 1, getDefaultFareRate(VehicleType::BIKE)) {}
     
     string getTypeString() const override { return "Bike"; }
 };
@@ -38,7 +49,7 @@ public:
 class Sedan : public Vehicle {
 public:
     Sedan(const string& id, const string& plate)
-        : Vehicle(id, plate, VehicleType::SEDAN, 4, 12.0) {}
+        : Vehicle(id, plate, VehicleType::SEDAN, 4, getDefaultFareRate(VehicleType::SEDAN)) {}
     
     string getTypeString() const override { return "Sedan"; }
 };
@@ -46,7 +57,7 @@ public:
 class SUV : public Vehicle {
 public:
     SUV(const string& id, const string& plate)
-        : Vehicle(id, plate, VehicleType::SUV, 6, 18.0) {}
+        : Vehicle(id, plate, VehicleType::SUV, 6, getDefaultFareRate(VehicleType::SUV)) {}
     
     string getTypeString() const override { return "SUV"; }
 };
@@ -54,7 +65,7 @@ public:
 class AutoRickshaw : public Vehicle {
 public:
     AutoRickshaw(const string& id, const string& plate)
-        : Vehicle(id, plate, VehicleType::AUTO_RICKSHAW, 3, 6.0) {}
+        : Vehicle(id, plate, VehicleType::AUTO_RICKSHAW, 3, getDefaultFareRate(VehicleType::AUTO_RICKSHAW)) {}
     
     string getTypeString() const override { return "Auto-Rickshaw"; }
 };